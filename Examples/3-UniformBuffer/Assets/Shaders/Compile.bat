@@ -1,8 +1,23 @@
 @echo off
 
+rem SPIR-V binaries are only ever produced here - compiled by glslc and checked by spirv-val.
+rem Called by the build with "NoPause", so a shader that fails to compile or validate fails the build
+
+setlocal
 set VulkanPath=%VULKAN_SDK%
+pushd "%~dp0"
+
+call :Compile Shader.vert vert.spv || goto :Done
+call :Compile InstancedShader.vert instanced_vert.spv || goto :Done
+call :Compile Shader.frag frag.spv || goto :Done
 
-"%VulkanPath%\Bin\glslc.exe" .\Shader.vert -o vert.spv
-"%VulkanPath%\Bin\glslc.exe" .\Shader.frag -o frag.spv
+:Done
+set Result=%errorlevel%
+popd
+if /i not "%~1"=="NoPause" pause
+exit /b %Result%
 
-pause
+:Compile
+"%VulkanPath%\Bin\glslc.exe" .\%1 -o %2 || exit /b 1
+"%VulkanPath%\Bin\spirv-val.exe" %2 || exit /b 1
+exit /b 0
@@ -0,0 +1,29 @@
+#version 450
+
+layout(location = 0) in vec3 VertexPos;
+layout(location = 1) in vec3 VertexColor;
+
+// Per instance, one location for every column(2 - 5)
+layout(location = 2) in mat4 InstanceModel;
+
+layout(location = 0) out vec3 FragColor;
+
+layout(set = 0, binding = 0) uniform MatricesUBO {
+    mat4 ProjectionView;
+} UBO;
+
+layout(set = 0, binding = 1) uniform ObjectsUBO {
+    mat4 Models[256];
+} Objects;
+
+layout(push_constant) uniform ObjectPushConstants {
+    uint ObjectIndex;
+    uint MaterialIndex;
+} Object;
+
+void main()
+{
+    mat4 Model = Objects.Models[Object.ObjectIndex];
+    gl_Position = UBO.ProjectionView * InstanceModel * Model * vec4(VertexPos, 1.0);
+    FragColor = VertexColor;
+}
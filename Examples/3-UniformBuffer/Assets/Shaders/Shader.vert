@@ -6,12 +6,21 @@ layout(location = 1) in vec3 VertexColor;
 layout(location = 0) out vec3 FragColor;
 
 layout(set = 0, binding = 0) uniform MatricesUBO {
-    mat4 Model;
     mat4 ProjectionView;
 } UBO;
 
+layout(set = 0, binding = 1) uniform ObjectsUBO {
+    mat4 Models[256];
+} Objects;
+
+layout(push_constant) uniform ObjectPushConstants {
+    uint ObjectIndex;
+    uint MaterialIndex;
+} Object;
+
 void main()
 {
-    gl_Position = UBO.ProjectionView * UBO.Model * vec4(VertexPos, 1.0);
+    mat4 Model = Objects.Models[Object.ObjectIndex];
+    gl_Position = UBO.ProjectionView * Model * vec4(VertexPos, 1.0);
     FragColor = VertexColor;
 }
@@ -0,0 +1,101 @@
+#include "AppSettings.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+
+AppSettings AppSettings::FromCommandLine(int Argc, char **Argv)
+{
+    AppSettings Settings{};
+    for (int i = 1; i < Argc; ++i)
+    {
+        std::string_view const Argument = Argv[i];
+        if (Argument == "--benchmark-uploads")
+        {
+            Settings.bBenchmarkUploads = true;
+        }
+        else if (Argument == "--track-host-allocations")
+        {
+            Settings.bTrackHostAllocations = true;
+        }
+        else if (Argument == "--benchmark-recording")
+        {
+            Settings.bBenchmarkRecording = true;
+        }
+        else if (Argument == "--cache-command-buffers")
+        {
+            Settings.bCacheCommandBuffers = true;
+        }
+        else if (Argument == "--benchmark-sorting")
+        {
+            Settings.bBenchmarkSorting = true;
+        }
+        else if (Argument == "--indirect-draws")
+        {
+            Settings.bIndirectDraws = true;
+        }
+        else if (Argument == "--wait-idle-on-resize")
+        {
+            Settings.bWaitIdleOnResize = true;
+        }
+        else if (Argument == "--headless")
+        {
+            Settings.bHeadless = true;
+        }
+        else if (Argument == "--no-pipeline-cache")
+        {
+            Settings.bNoPipelineCache = true;
+        }
+        else if (Argument == "--recording-threads" && i + 1 < Argc)
+        {
+            Settings.NumRecordingThreads = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+        }
+        else if (Argument == "--instances" && i + 1 < Argc)
+        {
+            Settings.NumInstances = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+        }
+        else if (Argument == "--frames-in-flight" && i + 1 < Argc)
+        {
+            uint32_t const NumFramesInFlight = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+            Settings.NumFramesInFlight =
+                std::clamp(NumFramesInFlight, s_MinFramesInFlight, s_MaxFramesInFlight);
+            if (Settings.NumFramesInFlight != NumFramesInFlight)
+            {
+                VKL_WARN(
+                    "Frames in flight {} is out of range, {} is used",
+                    NumFramesInFlight,
+                    Settings.NumFramesInFlight
+                );
+            }
+        }
+        else if (Argument == "--frames" && i + 1 < Argc)
+        {
+            Settings.NumHeadlessFrames = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+        }
+        else if (Argument == "--resize-interval-ms" && i + 1 < Argc)
+        {
+            Settings.ResizeIntervalMs = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+        }
+        else if (Argument == "--present-policy" && i + 1 < Argc)
+        {
+            std::optional<PresentPolicy> const Policy = PresentPolicyFromString(Argv[++i]);
+            if (Policy)
+            {
+                Settings.Present = *Policy;
+            }
+            else
+            {
+                VKL_WARN(
+                    "Unknown present policy {}, {} is used", Argv[i], PresentPolicyToString(Settings.Present)
+                );
+            }
+        }
+        else
+        {
+            VKL_WARN("Unknown command line argument {}", Argument);
+        }
+    }
+    return Settings;
+}
@@ -0,0 +1,36 @@
+#ifndef VULKANLEARNING_APPSETTINGS
+#define VULKANLEARNING_APPSETTINGS
+
+#include "PresentPolicy.h"
+
+#include <cstdint>
+
+// Options that can be changed from command line
+struct AppSettings
+{
+    static constexpr uint32_t s_MinFramesInFlight = 1;
+    static constexpr uint32_t s_MaxFramesInFlight = 4;
+
+    bool bBenchmarkUploads     = false; // --benchmark-uploads
+    bool bTrackHostAllocations = false; // --track-host-allocations
+    bool bBenchmarkRecording   = false; // --benchmark-recording
+    bool bCacheCommandBuffers  = false; // --cache-command-buffers
+    bool bBenchmarkSorting     = false; // --benchmark-sorting
+    bool bIndirectDraws        = false; // --indirect-draws
+    bool bWaitIdleOnResize     = false; // --wait-idle-on-resize, drain GPU before swapchain recreation
+    bool bHeadless             = false; // --headless, offscreen images instead of window and swapchain
+    bool bNoPipelineCache      = false; // --no-pipeline-cache, pipelines compiled from scratch every launch
+
+    uint32_t NumRecordingThreads = 0;    // --recording-threads N, 0 - draws are recorded into primary buffer
+    uint32_t NumInstances        = 0;    // --instances N, 0 - cube is drawn once without instancing
+    uint32_t NumFramesInFlight   = 2;    // --frames-in-flight N, 1 - lowest latency, more - higher throughput
+    uint32_t NumHeadlessFrames   = 1000; // --frames N, headless mode stops after that many frames
+    uint32_t ResizeIntervalMs    = 50;   // --resize-interval-ms N, swapchain rebuilt at most once per N ms
+
+    // --present-policy low-latency|vsync|uncapped|power-save, P cycles through them at runtime
+    PresentPolicy Present = PresentPolicy::LowLatency;
+
+    static AppSettings FromCommandLine(int Argc, char **Argv);
+};
+
+#endif // !VULKANLEARNING_APPSETTINGS
@@ -78,7 +78,7 @@ void Camera::ProcessRotation(glm::vec2 CursorDelta, float Sensitivity, float Ela
 void Camera::SetViewportSize(glm::vec2 ViewportSize)
 {
     m_ViewportSize = ViewportSize;
-    RecalculateViewMatrix();
+    RecalculateProjectionMatrix(); // Aspect ratio
 }
 
 void Camera::SetNearClip(float NearClip)
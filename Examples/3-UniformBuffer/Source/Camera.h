@@ -35,6 +35,9 @@ public:
 
     void SetViewportSize(glm::vec2 ViewportSize);
 
+    float GetNearClip() const { return m_NearClip; }
+    float GetFarClip() const { return m_FarClip; }
+
     void SetNearClip(float NearClip);
     void SetFarClip(float FarClip);
 
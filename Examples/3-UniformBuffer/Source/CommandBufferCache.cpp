@@ -0,0 +1,110 @@
+#include "CommandBufferCache.h"
+
+#include "Log.h"
+
+void CommandBufferCache::Init(
+    VkDevice                     Device,
+    uint32_t                     QueueFamilyIndex,
+    DeletionQueue               *Deletion,
+    TimelineSemaphore           *GraphicsTimeline,
+    VkAllocationCallbacks const *pAllocator
+)
+{
+    m_VkDevice         = Device;
+    m_Deletion         = Deletion;
+    m_GraphicsTimeline = GraphicsTimeline;
+    m_pVkAllocator     = pAllocator;
+
+    // Entries are re-recorded one by one, so every buffer has to be resettable on its own
+    VkCommandPoolCreateInfo CommandPoolInfo{};
+    CommandPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    CommandPoolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    CommandPoolInfo.queueFamilyIndex = QueueFamilyIndex;
+
+    if (vkCreateCommandPool(m_VkDevice, &CommandPoolInfo, m_pVkAllocator, &m_VkCommandPool) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to create cache VkCommandPool!");
+        exit(1);
+    }
+}
+
+void CommandBufferCache::Shutdown()
+{
+    VKL_INFO("CommandBufferCache: {} hits, {} recordings", m_NumHits, m_NumRecordings);
+
+    FreeCommandBuffers(TakeCommandBuffers());
+    vkDestroyCommandPool(m_VkDevice, m_VkCommandPool, m_pVkAllocator);
+    m_VkCommandPool = VK_NULL_HANDLE;
+}
+
+void CommandBufferCache::Resize(uint32_t NumSwapchainImages, uint32_t NumFrameSlots)
+{
+    m_Deletion->Push(
+        m_GraphicsTimeline->GetLastSubmittedValue(),
+        [this, OldCommandBuffers = TakeCommandBuffers()]() { FreeCommandBuffers(OldCommandBuffers); }
+    );
+
+    m_NumFrameSlots = NumFrameSlots;
+    m_Entries.resize(static_cast<size_t>(NumSwapchainImages) * NumFrameSlots);
+
+    std::vector<VkCommandBuffer> CommandBuffers(m_Entries.size());
+
+    VkCommandBufferAllocateInfo CommandBufferInfo{};
+    CommandBufferInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    CommandBufferInfo.commandPool        = m_VkCommandPool;
+    CommandBufferInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    CommandBufferInfo.commandBufferCount = static_cast<uint32_t>(CommandBuffers.size());
+
+    if (vkAllocateCommandBuffers(m_VkDevice, &CommandBufferInfo, CommandBuffers.data()) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to allocate cached VkCommandBuffers!");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < m_Entries.size(); ++i)
+    {
+        m_Entries[i].CommandBuffer = CommandBuffers[i];
+        m_Entries[i].Generation    = 0;
+    }
+}
+
+VkCommandBuffer CommandBufferCache::Acquire(uint32_t SwapchainImageIndex, uint32_t FrameSlot, bool &bOutdated)
+{
+    Entry &CacheEntry = m_Entries[static_cast<size_t>(SwapchainImageIndex) * m_NumFrameSlots + FrameSlot];
+
+    bOutdated = CacheEntry.Generation != m_Generation;
+    if (bOutdated)
+    {
+        // vkBeginCommandBuffer resets it implicitly
+        CacheEntry.Generation = m_Generation;
+        m_NumRecordings++;
+    }
+    else
+    {
+        m_NumHits++;
+    }
+    return CacheEntry.CommandBuffer;
+}
+
+std::vector<VkCommandBuffer> CommandBufferCache::TakeCommandBuffers()
+{
+    std::vector<VkCommandBuffer> CommandBuffers;
+    CommandBuffers.reserve(m_Entries.size());
+    for (Entry const &CacheEntry : m_Entries)
+    {
+        CommandBuffers.push_back(CacheEntry.CommandBuffer);
+    }
+    m_Entries.clear();
+    return CommandBuffers;
+}
+
+void CommandBufferCache::FreeCommandBuffers(std::vector<VkCommandBuffer> const &CommandBuffers)
+{
+    if (CommandBuffers.empty())
+    {
+        return;
+    }
+    vkFreeCommandBuffers(
+        m_VkDevice, m_VkCommandPool, static_cast<uint32_t>(CommandBuffers.size()), CommandBuffers.data()
+    );
+}
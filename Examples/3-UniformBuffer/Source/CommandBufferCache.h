@@ -0,0 +1,62 @@
+#ifndef VULKANLEARNING_COMMANDBUFFERCACHE
+#define VULKANLEARNING_COMMANDBUFFERCACHE
+
+#include "DeletionQueue.h"
+#include "TimelineSemaphore.h"
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Primary command buffers recorded once per (swapchain image, frame in flight) and submitted again every time
+// the same pair comes around. Invalidate re-records them lazily, each one when it's needed next time
+class CommandBufferCache
+{
+public:
+    void Init(
+        VkDevice                     Device,
+        uint32_t                     QueueFamilyIndex,
+        DeletionQueue               *Deletion,
+        TimelineSemaphore           *GraphicsTimeline,
+        VkAllocationCallbacks const *pAllocator
+    );
+    void Shutdown();
+
+    // Previously cached command buffers may still be in use by frames in flight, they are freed once done
+    void Resize(uint32_t NumSwapchainImages, uint32_t NumFrameSlots);
+
+    // Something recorded changed(pipeline, geometry, draw list)
+    void Invalidate() { m_Generation++; }
+
+    // Previous submission of FrameSlot has to be finished. bOutdated - caller has to record it again
+    VkCommandBuffer Acquire(uint32_t SwapchainImageIndex, uint32_t FrameSlot, bool &bOutdated);
+
+    uint64_t GetNumHits() const { return m_NumHits; }
+    uint64_t GetNumRecordings() const { return m_NumRecordings; }
+
+private:
+    struct Entry
+    {
+        VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+        uint64_t        Generation    = 0; // 0 - never recorded
+    };
+
+    std::vector<VkCommandBuffer> TakeCommandBuffers();
+    void                         FreeCommandBuffers(std::vector<VkCommandBuffer> const &CommandBuffers);
+
+private:
+    VkDevice                     m_VkDevice         = VK_NULL_HANDLE;
+    DeletionQueue               *m_Deletion         = nullptr;
+    TimelineSemaphore           *m_GraphicsTimeline = nullptr;
+    VkAllocationCallbacks const *m_pVkAllocator     = nullptr;
+    VkCommandPool                m_VkCommandPool    = VK_NULL_HANDLE;
+
+    std::vector<Entry> m_Entries; // Indexed by SwapchainImageIndex * NumFrameSlots + FrameSlot
+    uint32_t           m_NumFrameSlots = 0;
+
+    uint64_t m_Generation    = 1;
+    uint64_t m_NumHits       = 0;
+    uint64_t m_NumRecordings = 0;
+};
+
+#endif // !VULKANLEARNING_COMMANDBUFFERCACHE
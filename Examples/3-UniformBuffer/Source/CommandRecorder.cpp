@@ -0,0 +1,199 @@
+#include "CommandRecorder.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+CommandRecorderStats &CommandRecorderStats::operator+=(CommandRecorderStats const &Other)
+{
+    NumIssued += Other.NumIssued;
+    NumElided += Other.NumElided;
+    NumDraws += Other.NumDraws;
+    return *this;
+}
+
+void CommandRecorder::BindPipeline(VkPipeline Pipeline)
+{
+    if (ShouldIssue(Pipeline == m_BoundPipeline))
+    {
+        vkCmdBindPipeline(m_VkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline);
+        m_BoundPipeline = Pipeline;
+    }
+}
+
+void CommandRecorder::SetViewport(VkViewport const &Viewport)
+{
+    bool const bRedundant = m_bViewportSet && Viewport.x == m_Viewport.x && Viewport.y == m_Viewport.y &&
+                            Viewport.width == m_Viewport.width && Viewport.height == m_Viewport.height &&
+                            Viewport.minDepth == m_Viewport.minDepth &&
+                            Viewport.maxDepth == m_Viewport.maxDepth;
+    if (ShouldIssue(bRedundant))
+    {
+        vkCmdSetViewport(m_VkCommandBuffer, 0, 1, &Viewport);
+        m_Viewport     = Viewport;
+        m_bViewportSet = true;
+    }
+}
+
+void CommandRecorder::SetScissor(VkRect2D const &Scissor)
+{
+    bool const bRedundant = m_bScissorSet && Scissor.offset.x == m_Scissor.offset.x &&
+                            Scissor.offset.y == m_Scissor.offset.y &&
+                            Scissor.extent.width == m_Scissor.extent.width &&
+                            Scissor.extent.height == m_Scissor.extent.height;
+    if (ShouldIssue(bRedundant))
+    {
+        vkCmdSetScissor(m_VkCommandBuffer, 0, 1, &Scissor);
+        m_Scissor     = Scissor;
+        m_bScissorSet = true;
+    }
+}
+
+void CommandRecorder::BindVertexBuffer(uint32_t Binding, VkBuffer Buffer, VkDeviceSize Offset)
+{
+    if (Binding >= s_MaxVertexBindings)
+    {
+        VKL_CRITICAL("CommandRecorder can't track vertex buffer binding {}!", Binding);
+        exit(1);
+    }
+
+    BoundVertexBuffer &Bound = m_BoundVertexBuffers[Binding];
+    if (ShouldIssue(Buffer == Bound.Buffer && Offset == Bound.Offset))
+    {
+        vkCmdBindVertexBuffers(m_VkCommandBuffer, Binding, 1, &Buffer, &Offset);
+        Bound.Buffer = Buffer;
+        Bound.Offset = Offset;
+    }
+}
+
+void CommandRecorder::BindIndexBuffer(VkBuffer Buffer, VkDeviceSize Offset, VkIndexType IndexType)
+{
+    bool const bRedundant =
+        Buffer == m_BoundIndexBuffer && Offset == m_BoundIndexBufferOffset && IndexType == m_BoundIndexType;
+    if (ShouldIssue(bRedundant))
+    {
+        vkCmdBindIndexBuffer(m_VkCommandBuffer, Buffer, Offset, IndexType);
+        m_BoundIndexBuffer       = Buffer;
+        m_BoundIndexBufferOffset = Offset;
+        m_BoundIndexType         = IndexType;
+    }
+}
+
+void CommandRecorder::BindDescriptorSet(
+    VkPipelineLayout Layout,
+    uint32_t         SetIndex,
+    VkDescriptorSet  Set,
+    uint32_t         NumDynamicOffsets,
+    uint32_t const  *DynamicOffsets
+)
+{
+    if (SetIndex >= s_MaxDescriptorSets || NumDynamicOffsets > s_MaxDynamicOffsets)
+    {
+        VKL_CRITICAL(
+            "CommandRecorder can't track descriptor set {} with {} dynamic offsets!",
+            SetIndex,
+            NumDynamicOffsets
+        );
+        exit(1);
+    }
+
+    // Sets bound with other layout may be disturbed - don't trust any of them
+    if (Layout != m_BoundLayout)
+    {
+        m_BoundDescriptorSets.fill(BoundDescriptorSet{});
+        m_BoundLayout = Layout;
+    }
+
+    BoundDescriptorSet &Bound = m_BoundDescriptorSets[SetIndex];
+
+    bool const bRedundant =
+        Bound.Set == Set && Bound.NumDynamicOffsets == NumDynamicOffsets &&
+        std::equal(DynamicOffsets, DynamicOffsets + NumDynamicOffsets, Bound.DynamicOffsets.begin());
+    if (ShouldIssue(bRedundant))
+    {
+        vkCmdBindDescriptorSets(
+            m_VkCommandBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            Layout,
+            SetIndex,
+            1,
+            &Set,
+            NumDynamicOffsets,
+            DynamicOffsets
+        );
+        Bound.Set               = Set;
+        Bound.NumDynamicOffsets = NumDynamicOffsets;
+        std::copy(DynamicOffsets, DynamicOffsets + NumDynamicOffsets, Bound.DynamicOffsets.begin());
+    }
+}
+
+void CommandRecorder::PushConstants(
+    VkPipelineLayout Layout, VkShaderStageFlags Stages, uint32_t Offset, uint32_t Size, void const *Data
+)
+{
+    if (Offset + Size > s_MaxPushConstantsSize)
+    {
+        VKL_CRITICAL("CommandRecorder can't track push constants range [{}, {})!", Offset, Offset + Size);
+        exit(1);
+    }
+
+    bool const bRedundant = Layout == m_PushedLayout && Stages == m_PushedStages &&
+                            Offset == m_PushedOffset && Size == m_PushedSize &&
+                            std::memcmp(Data, m_PushedData.data(), Size) == 0;
+    if (ShouldIssue(bRedundant))
+    {
+        vkCmdPushConstants(m_VkCommandBuffer, Layout, Stages, Offset, Size, Data);
+        m_PushedLayout = Layout;
+        m_PushedStages = Stages;
+        m_PushedOffset = Offset;
+        m_PushedSize   = Size;
+        std::memcpy(m_PushedData.data(), Data, Size);
+    }
+}
+
+void CommandRecorder::DrawIndexed(
+    uint32_t IndexCount,
+    uint32_t InstanceCount,
+    uint32_t FirstIndex,
+    int32_t  VertexOffset,
+    uint32_t FirstInstance
+)
+{
+    vkCmdDrawIndexed(m_VkCommandBuffer, IndexCount, InstanceCount, FirstIndex, VertexOffset, FirstInstance);
+    m_Stats.NumDraws++;
+}
+
+void CommandRecorder::DrawIndexedIndirect(
+    VkBuffer Buffer, VkDeviceSize Offset, uint32_t DrawCount, uint32_t Stride
+)
+{
+    vkCmdDrawIndexedIndirect(m_VkCommandBuffer, Buffer, Offset, DrawCount, Stride);
+    m_Stats.NumDraws++;
+}
+
+void CommandRecorder::DrawIndexedIndirectCount(
+    VkBuffer     Buffer,
+    VkDeviceSize Offset,
+    VkBuffer     CountBuffer,
+    VkDeviceSize CountOffset,
+    uint32_t     MaxDrawCount,
+    uint32_t     Stride
+)
+{
+    vkCmdDrawIndexedIndirectCount(
+        m_VkCommandBuffer, Buffer, Offset, CountBuffer, CountOffset, MaxDrawCount, Stride
+    );
+    m_Stats.NumDraws++;
+}
+
+bool CommandRecorder::ShouldIssue(bool bRedundant)
+{
+    if (bRedundant)
+    {
+        m_Stats.NumElided++;
+        return false;
+    }
+    m_Stats.NumIssued++;
+    return true;
+}
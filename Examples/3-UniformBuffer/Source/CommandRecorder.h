@@ -0,0 +1,114 @@
+#ifndef VULKANLEARNING_COMMANDRECORDER
+#define VULKANLEARNING_COMMANDRECORDER
+
+#include <array>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+struct CommandRecorderStats
+{
+    uint64_t NumIssued = 0; // State commands that reached command buffer
+    uint64_t NumElided = 0; // State commands skipped because they wouldn't change anything
+    uint64_t NumDraws  = 0; // Draw commands, an indirect one counts once
+
+    CommandRecorderStats &operator+=(CommandRecorderStats const &Other);
+};
+
+// Wrapper over VkCommandBuffer that remembers bound graphics state and skips commands that change nothing.
+// Starts with nothing bound - state isn't inherited between command buffers, secondary ones included
+class CommandRecorder
+{
+public:
+    static constexpr uint32_t s_MaxDescriptorSets    = 4;
+    static constexpr uint32_t s_MaxDynamicOffsets    = 4; // Per descriptor set
+    static constexpr uint32_t s_MaxVertexBindings    = 2;
+    static constexpr uint32_t s_MaxPushConstantsSize = 128; // Minimal guaranteed maxPushConstantsSize
+
+    explicit CommandRecorder(VkCommandBuffer CommandBuffer) : m_VkCommandBuffer(CommandBuffer) {}
+
+    void BindPipeline(VkPipeline Pipeline);
+    void SetViewport(VkViewport const &Viewport);
+    void SetScissor(VkRect2D const &Scissor);
+
+    void BindVertexBuffer(uint32_t Binding, VkBuffer Buffer, VkDeviceSize Offset = 0);
+    void BindIndexBuffer(VkBuffer Buffer, VkDeviceSize Offset, VkIndexType IndexType);
+
+    void BindDescriptorSet(
+        VkPipelineLayout Layout,
+        uint32_t         SetIndex,
+        VkDescriptorSet  Set,
+        uint32_t         NumDynamicOffsets = 0,
+        uint32_t const  *DynamicOffsets    = nullptr
+    );
+
+    void PushConstants(
+        VkPipelineLayout Layout, VkShaderStageFlags Stages, uint32_t Offset, uint32_t Size, void const *Data
+    );
+
+    void DrawIndexed(
+        uint32_t IndexCount,
+        uint32_t InstanceCount,
+        uint32_t FirstIndex,
+        int32_t  VertexOffset,
+        uint32_t FirstInstance
+    );
+    void DrawIndexedIndirect(VkBuffer Buffer, VkDeviceSize Offset, uint32_t DrawCount, uint32_t Stride);
+    void DrawIndexedIndirectCount(
+        VkBuffer     Buffer,
+        VkDeviceSize Offset,
+        VkBuffer     CountBuffer,
+        VkDeviceSize CountOffset,
+        uint32_t     MaxDrawCount,
+        uint32_t     Stride
+    );
+
+    VkCommandBuffer             Get() const { return m_VkCommandBuffer; }
+    CommandRecorderStats const &GetStats() const { return m_Stats; }
+
+private:
+    struct BoundVertexBuffer
+    {
+        VkBuffer     Buffer = VK_NULL_HANDLE;
+        VkDeviceSize Offset = 0;
+    };
+
+    struct BoundDescriptorSet
+    {
+        VkDescriptorSet                           Set               = VK_NULL_HANDLE;
+        uint32_t                                  NumDynamicOffsets = 0;
+        std::array<uint32_t, s_MaxDynamicOffsets> DynamicOffsets{};
+    };
+
+    // Counts command as issued if it's not redundant
+    bool ShouldIssue(bool bRedundant);
+
+private:
+    VkCommandBuffer m_VkCommandBuffer = VK_NULL_HANDLE;
+
+    VkPipeline m_BoundPipeline = VK_NULL_HANDLE;
+
+    bool       m_bViewportSet = false;
+    bool       m_bScissorSet  = false;
+    VkViewport m_Viewport{};
+    VkRect2D   m_Scissor{};
+
+    std::array<BoundVertexBuffer, s_MaxVertexBindings> m_BoundVertexBuffers{};
+
+    VkBuffer     m_BoundIndexBuffer       = VK_NULL_HANDLE;
+    VkDeviceSize m_BoundIndexBufferOffset = 0;
+    VkIndexType  m_BoundIndexType         = VK_INDEX_TYPE_UINT16;
+
+    VkPipelineLayout                                    m_BoundLayout = VK_NULL_HANDLE;
+    std::array<BoundDescriptorSet, s_MaxDescriptorSets> m_BoundDescriptorSets{};
+
+    // Last push only, covers the usual case of same range pushed before every draw
+    VkPipelineLayout                            m_PushedLayout = VK_NULL_HANDLE;
+    VkShaderStageFlags                          m_PushedStages = 0;
+    uint32_t                                    m_PushedOffset = 0;
+    uint32_t                                    m_PushedSize   = 0;
+    std::array<uint8_t, s_MaxPushConstantsSize> m_PushedData{};
+
+    CommandRecorderStats m_Stats;
+};
+
+#endif // !VULKANLEARNING_COMMANDRECORDER
@@ -0,0 +1,26 @@
+#include "DeletionQueue.h"
+
+#include <utility>
+
+void DeletionQueue::Push(uint64_t RetireValue, std::function<void()> &&Deleter)
+{
+    m_Entries.push_back({RetireValue, std::move(Deleter)});
+}
+
+void DeletionQueue::Flush(uint64_t CompletedValue)
+{
+    while (!m_Entries.empty() && m_Entries.front().RetireValue <= CompletedValue)
+    {
+        m_Entries.front().Deleter();
+        m_Entries.pop_front();
+    }
+}
+
+void DeletionQueue::FlushAll()
+{
+    while (!m_Entries.empty())
+    {
+        m_Entries.front().Deleter();
+        m_Entries.pop_front();
+    }
+}
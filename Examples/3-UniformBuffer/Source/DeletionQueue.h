@@ -0,0 +1,32 @@
+#ifndef VULKANLEARNING_DELETIONQUEUE
+#define VULKANLEARNING_DELETIONQUEUE
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// Destroys retired resources once GPU passes the timeline value they were retired at.
+// Values have to be pushed in non-decreasing order, same as timeline semaphore values
+class DeletionQueue
+{
+public:
+    void Push(uint64_t RetireValue, std::function<void()> &&Deleter);
+
+    // Runs deleters of everything retired at or before CompletedValue
+    void Flush(uint64_t CompletedValue);
+    void FlushAll();
+
+    size_t GetSize() const { return m_Entries.size(); }
+
+private:
+    struct Entry
+    {
+        uint64_t              RetireValue = 0;
+        std::function<void()> Deleter;
+    };
+
+private:
+    std::deque<Entry> m_Entries;
+};
+
+#endif // !VULKANLEARNING_DELETIONQUEUE
@@ -0,0 +1,316 @@
+#include "DeviceMemoryAllocator.h"
+
+#include "Log.h"
+
+#include <algorithm>
+
+void DeviceMemoryAllocator::Init(
+    VkDevice                     Device,
+    MemoryPolicy const          *Policy,
+    MemoryBudgetTracker         *BudgetTracker,
+    VkAllocationCallbacks const *pAllocator
+)
+{
+    m_VkDevice      = Device;
+    m_Policy        = Policy;
+    m_BudgetTracker = BudgetTracker;
+    m_pVkAllocator  = pAllocator;
+
+    VKL_TRACE("DeviceMemoryAllocator initialized");
+}
+
+void DeviceMemoryAllocator::Shutdown()
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_Blocks.size()); ++i)
+    {
+        if (m_Blocks[i].Memory == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+        if (m_Blocks[i].NumAllocations != 0)
+        {
+            VKL_WARN("Memory block {} still has {} allocations on shutdown!", i, m_Blocks[i].NumAllocations);
+        }
+        DestroyBlock(i);
+    }
+    m_Blocks.clear();
+
+    VKL_TRACE("DeviceMemoryAllocator shut down");
+}
+
+DeviceMemoryAllocation DeviceMemoryAllocator::Allocate(
+    VkMemoryRequirements const &Requirements, MemoryUsage Usage
+)
+{
+    DeviceMemoryAllocation Allocation{};
+
+    std::vector<uint32_t> const CandidateMemoryTypes =
+        m_Policy->GetCandidateMemoryTypes(Usage, Requirements.memoryTypeBits);
+
+    for (uint32_t MemoryTypeIndex : CandidateMemoryTypes)
+    {
+        if (TryAllocateFromMemoryType(MemoryTypeIndex, Requirements, true, Allocation))
+        {
+            return Allocation;
+        }
+        VKL_WARN(
+            "Out of memory or budget in type {}, falling back for {} usage",
+            MemoryTypeIndex,
+            MemoryUsageToString(Usage)
+        );
+    }
+
+    // Paging is still better than failing
+    for (uint32_t MemoryTypeIndex : CandidateMemoryTypes)
+    {
+        if (TryAllocateFromMemoryType(MemoryTypeIndex, Requirements, false, Allocation))
+        {
+            VKL_WARN("Allocated {} bytes in type {} over budget", Requirements.size, MemoryTypeIndex);
+            return Allocation;
+        }
+    }
+
+    VKL_CRITICAL("Failed to allocate {} bytes for {} usage!", Requirements.size, MemoryUsageToString(Usage));
+    exit(1);
+}
+
+void DeviceMemoryAllocator::Free(DeviceMemoryAllocation &Allocation)
+{
+    if (Allocation.Memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    MemoryBlock &Block = m_Blocks[Allocation.BlockIndex];
+    Block.Ranges.Free(Allocation.Offset, Allocation.Size);
+    Block.NumAllocations--;
+
+    if (Block.NumAllocations == 0)
+    {
+        // Keep one empty shared block per memory type to avoid allocate/free ping-pong
+        bool bHasOtherEmptyBlock = false;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_Blocks.size()); ++i)
+        {
+            MemoryBlock const &Other = m_Blocks[i];
+            if (i != Allocation.BlockIndex && Other.Memory != VK_NULL_HANDLE && !Other.bDedicated &&
+                Other.MemoryTypeIndex == Block.MemoryTypeIndex && Other.NumAllocations == 0)
+            {
+                bHasOtherEmptyBlock = true;
+                break;
+            }
+        }
+
+        if (Block.bDedicated || bHasOtherEmptyBlock)
+        {
+            DestroyBlock(Allocation.BlockIndex);
+        }
+    }
+
+    Allocation = DeviceMemoryAllocation{};
+}
+
+std::vector<DeviceMemoryBlockStats> DeviceMemoryAllocator::GetStats() const
+{
+    std::vector<DeviceMemoryBlockStats> Stats;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_Blocks.size()); ++i)
+    {
+        MemoryBlock const &Block = m_Blocks[i];
+        if (Block.Memory == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+
+        DeviceMemoryBlockStats BlockStats{};
+        BlockStats.BlockIndex           = i;
+        BlockStats.MemoryTypeIndex      = Block.MemoryTypeIndex;
+        BlockStats.BlockSize            = Block.Size;
+        BlockStats.UsedSize             = Block.Ranges.GetUsedSize();
+        BlockStats.LargestFreeRangeSize = Block.Ranges.GetLargestFreeRange();
+        BlockStats.NumAllocations       = Block.NumAllocations;
+        BlockStats.NumFreeRanges        = Block.Ranges.GetNumFreeRanges();
+        BlockStats.bDedicated           = Block.bDedicated;
+        Stats.push_back(BlockStats);
+    }
+    return Stats;
+}
+
+void DeviceMemoryAllocator::LogStats() const
+{
+    std::vector<DeviceMemoryBlockStats> const Stats = GetStats();
+
+    VKL_INFO("Device memory: {} VkDeviceMemory allocations", m_NumDeviceMemoryAllocations);
+    for (DeviceMemoryBlockStats const &BlockStats : Stats)
+    {
+        VKL_INFO(
+            "Block {} (type {}{}): {} allocations, {}/{} bytes used, {} free ranges, largest free {} bytes",
+            BlockStats.BlockIndex,
+            BlockStats.MemoryTypeIndex,
+            BlockStats.bDedicated ? ", dedicated" : "",
+            BlockStats.NumAllocations,
+            BlockStats.UsedSize,
+            BlockStats.BlockSize,
+            BlockStats.NumFreeRanges,
+            BlockStats.LargestFreeRangeSize
+        );
+    }
+}
+
+VkDeviceSize DeviceMemoryAllocator::GetPreferredBlockSize(uint32_t MemoryTypeIndex) const
+{
+    VkPhysicalDeviceMemoryProperties const &MemoryProperties = m_Policy->GetMemoryProperties();
+
+    uint32_t const     HeapIndex = MemoryProperties.memoryTypes[MemoryTypeIndex].heapIndex;
+    VkDeviceSize const HeapSize  = MemoryProperties.memoryHeaps[HeapIndex].size;
+
+    // Small heaps(like 256MB BAR) shouldn't be eaten by few blocks
+    return std::min(s_DefaultBlockSize, HeapSize / 8);
+}
+
+bool DeviceMemoryAllocator::TryAllocateFromMemoryType(
+    uint32_t                    MemoryTypeIndex,
+    VkMemoryRequirements const &Requirements,
+    bool                        bWithinBudget,
+    DeviceMemoryAllocation     &Allocation
+)
+{
+    VkDeviceSize const BlockSize = GetPreferredBlockSize(MemoryTypeIndex);
+
+    // Big resources would waste most of the shared block - give them their own
+    if (Requirements.size > BlockSize / 2)
+    {
+        if (bWithinBudget && !ReserveBudget(MemoryTypeIndex, Requirements.size))
+        {
+            return false;
+        }
+        std::optional<uint32_t> const BlockIndex = CreateBlock(MemoryTypeIndex, Requirements.size, true);
+        return BlockIndex.has_value() && TryAllocateFromBlock(BlockIndex.value(), Requirements, Allocation);
+    }
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_Blocks.size()); ++i)
+    {
+        MemoryBlock const &Block = m_Blocks[i];
+        if (Block.Memory == VK_NULL_HANDLE || Block.bDedicated || Block.MemoryTypeIndex != MemoryTypeIndex)
+        {
+            continue;
+        }
+        if (TryAllocateFromBlock(i, Requirements, Allocation))
+        {
+            return true;
+        }
+    }
+
+    // Existing blocks are already counted in usage, only new ones have to fit in budget
+    if (bWithinBudget && !ReserveBudget(MemoryTypeIndex, BlockSize))
+    {
+        return false;
+    }
+    std::optional<uint32_t> const BlockIndex = CreateBlock(MemoryTypeIndex, BlockSize, false);
+    return BlockIndex.has_value() && TryAllocateFromBlock(BlockIndex.value(), Requirements, Allocation);
+}
+
+bool DeviceMemoryAllocator::ReserveBudget(uint32_t MemoryTypeIndex, VkDeviceSize Size)
+{
+    uint32_t const HeapIndex = m_Policy->GetMemoryProperties().memoryTypes[MemoryTypeIndex].heapIndex;
+    if (m_BudgetTracker->CanAllocate(HeapIndex, Size))
+    {
+        return true;
+    }
+
+    if (m_EvictionCallback && m_EvictionCallback(HeapIndex, Size))
+    {
+        return m_BudgetTracker->CanAllocate(HeapIndex, Size);
+    }
+    return false;
+}
+
+std::optional<uint32_t> DeviceMemoryAllocator::CreateBlock(
+    uint32_t MemoryTypeIndex, VkDeviceSize Size, bool bDedicated
+)
+{
+    MemoryBlock Block{};
+    Block.Size            = Size;
+    Block.MemoryTypeIndex = MemoryTypeIndex;
+    Block.Ranges          = FreeListAllocator(Size);
+    Block.bDedicated      = bDedicated;
+
+    VkMemoryAllocateInfo MemoryAllocateInfo{};
+    MemoryAllocateInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    MemoryAllocateInfo.allocationSize  = Size;
+    MemoryAllocateInfo.memoryTypeIndex = MemoryTypeIndex;
+
+    if (vkAllocateMemory(m_VkDevice, &MemoryAllocateInfo, m_pVkAllocator, &Block.Memory) != VK_SUCCESS)
+    {
+        return std::nullopt; // Caller falls back to another memory type
+    }
+    m_NumDeviceMemoryAllocations++;
+    m_BudgetTracker->NotifyAllocated(
+        m_Policy->GetMemoryProperties().memoryTypes[MemoryTypeIndex].heapIndex, Block.Size
+    );
+
+    // Host visible blocks stay mapped for whole lifetime, sub-ranges can't be mapped separately
+    if (m_Policy->IsHostVisible(MemoryTypeIndex))
+    {
+        if (vkMapMemory(m_VkDevice, Block.Memory, 0, VK_WHOLE_SIZE, 0, &Block.MappedData) != VK_SUCCESS)
+        {
+            VKL_CRITICAL("Failed to map VkDeviceMemory!");
+            exit(1);
+        }
+    }
+
+    VKL_TRACE("Allocated VkDeviceMemory block of {} bytes for memory type {}", Size, MemoryTypeIndex);
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_Blocks.size()); ++i)
+    {
+        if (m_Blocks[i].Memory == VK_NULL_HANDLE)
+        {
+            m_Blocks[i] = std::move(Block);
+            return i;
+        }
+    }
+    m_Blocks.push_back(std::move(Block));
+    return static_cast<uint32_t>(m_Blocks.size() - 1);
+}
+
+void DeviceMemoryAllocator::DestroyBlock(uint32_t BlockIndex)
+{
+    MemoryBlock &Block = m_Blocks[BlockIndex];
+    if (Block.MappedData)
+    {
+        vkUnmapMemory(m_VkDevice, Block.Memory);
+    }
+    vkFreeMemory(m_VkDevice, Block.Memory, m_pVkAllocator);
+    m_NumDeviceMemoryAllocations--;
+    m_BudgetTracker->NotifyFreed(
+        m_Policy->GetMemoryProperties().memoryTypes[Block.MemoryTypeIndex].heapIndex, Block.Size
+    );
+
+    VKL_TRACE("Freed VkDeviceMemory block of {} bytes", Block.Size);
+
+    Block = MemoryBlock{};
+}
+
+bool DeviceMemoryAllocator::TryAllocateFromBlock(
+    uint32_t BlockIndex, VkMemoryRequirements const &Requirements, DeviceMemoryAllocation &Allocation
+)
+{
+    MemoryBlock &Block = m_Blocks[BlockIndex];
+
+    std::optional<uint64_t> const Offset = Block.Ranges.Allocate(Requirements.size, Requirements.alignment);
+    if (!Offset.has_value())
+    {
+        return false;
+    }
+    Block.NumAllocations++;
+
+    Allocation.Memory          = Block.Memory;
+    Allocation.Offset          = Offset.value();
+    Allocation.Size            = Requirements.size;
+    Allocation.MemoryTypeIndex = Block.MemoryTypeIndex;
+    Allocation.BlockIndex      = BlockIndex;
+    Allocation.MappedData      = nullptr;
+    if (Block.MappedData)
+    {
+        Allocation.MappedData = static_cast<char *>(Block.MappedData) + Offset.value();
+    }
+    return true;
+}
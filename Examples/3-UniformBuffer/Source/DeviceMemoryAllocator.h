@@ -0,0 +1,111 @@
+#ifndef VULKANLEARNING_DEVICEMEMORYALLOCATOR
+#define VULKANLEARNING_DEVICEMEMORYALLOCATOR
+
+#include "FreeListAllocator.h"
+#include "MemoryBudgetTracker.h"
+#include "MemoryPolicy.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Sub-range of VkDeviceMemory block, bind resources with Memory + Offset
+struct DeviceMemoryAllocation
+{
+    VkDeviceMemory Memory          = VK_NULL_HANDLE;
+    VkDeviceSize   Offset          = 0;
+    VkDeviceSize   Size            = 0;
+    uint32_t       MemoryTypeIndex = 0;
+    uint32_t       BlockIndex      = 0;
+    void          *MappedData      = nullptr; // Not null if memory type is HOST_VISIBLE, already offset
+};
+
+struct DeviceMemoryBlockStats
+{
+    uint32_t     BlockIndex           = 0;
+    uint32_t     MemoryTypeIndex      = 0;
+    VkDeviceSize BlockSize            = 0;
+    VkDeviceSize UsedSize             = 0;
+    VkDeviceSize LargestFreeRangeSize = 0;
+    uint32_t     NumAllocations       = 0;
+    uint32_t     NumFreeRanges        = 0;
+    bool         bDedicated           = false;
+};
+
+// Frees streamable resources living in HeapIndex, returns true if anything was freed
+using MemoryEvictionCallback = std::function<bool(uint32_t HeapIndex, VkDeviceSize RequiredSize)>;
+
+// Allocates big VkDeviceMemory blocks per memory type and hands out sub-ranges of them
+class DeviceMemoryAllocator
+{
+public:
+    static constexpr VkDeviceSize s_DefaultBlockSize = 64ull * 1024 * 1024;
+
+    void Init(
+        VkDevice                     Device,
+        MemoryPolicy const          *Policy,
+        MemoryBudgetTracker         *BudgetTracker,
+        VkAllocationCallbacks const *pAllocator
+    );
+    void Shutdown();
+
+    // Tries memory types in MemoryPolicy order until one of them has space within heap budget.
+    // Budget is ignored only if no candidate fits in it
+    DeviceMemoryAllocation Allocate(VkMemoryRequirements const &Requirements, MemoryUsage Usage);
+    void                   Free(DeviceMemoryAllocation &Allocation);
+
+    // Called before falling back to less preferable heap because preferred one is out of budget
+    void SetEvictionCallback(MemoryEvictionCallback &&Callback) { m_EvictionCallback = std::move(Callback); }
+
+    std::vector<DeviceMemoryBlockStats> GetStats() const;
+    void                                LogStats() const;
+
+    uint32_t GetNumDeviceMemoryAllocations() const { return m_NumDeviceMemoryAllocations; }
+
+private:
+    struct MemoryBlock
+    {
+        VkDeviceMemory    Memory          = VK_NULL_HANDLE; // VK_NULL_HANDLE - slot is unused
+        VkDeviceSize      Size            = 0;
+        uint32_t          MemoryTypeIndex = 0;
+        void             *MappedData      = nullptr;
+        FreeListAllocator Ranges;
+        uint32_t          NumAllocations = 0;
+        bool              bDedicated     = false;
+    };
+
+    VkDeviceSize GetPreferredBlockSize(uint32_t MemoryTypeIndex) const;
+
+    bool TryAllocateFromMemoryType(
+        uint32_t                    MemoryTypeIndex,
+        VkMemoryRequirements const &Requirements,
+        bool                        bWithinBudget,
+        DeviceMemoryAllocation     &Allocation
+    );
+
+    // Asks eviction callback for space if heap of memory type can't fit new block
+    bool ReserveBudget(uint32_t MemoryTypeIndex, VkDeviceSize Size);
+
+    std::optional<uint32_t> CreateBlock(uint32_t MemoryTypeIndex, VkDeviceSize Size, bool bDedicated);
+    void                    DestroyBlock(uint32_t BlockIndex);
+
+    bool TryAllocateFromBlock(
+        uint32_t BlockIndex, VkMemoryRequirements const &Requirements, DeviceMemoryAllocation &Allocation
+    );
+
+private:
+    VkDevice                     m_VkDevice      = VK_NULL_HANDLE;
+    MemoryPolicy const          *m_Policy        = nullptr;
+    MemoryBudgetTracker         *m_BudgetTracker = nullptr;
+    VkAllocationCallbacks const *m_pVkAllocator  = nullptr;
+
+    MemoryEvictionCallback m_EvictionCallback;
+
+    std::vector<MemoryBlock> m_Blocks;
+
+    uint32_t m_NumDeviceMemoryAllocations = 0;
+};
+
+#endif // !VULKANLEARNING_DEVICEMEMORYALLOCATOR
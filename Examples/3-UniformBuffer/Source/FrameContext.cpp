@@ -0,0 +1,93 @@
+#include "FrameContext.h"
+
+#include "Log.h"
+
+void FrameContext::Init(
+    VkDevice                     Device,
+    uint32_t                     QueueFamilyIndex,
+    uint32_t                     NumThreads,
+    VkAllocationCallbacks const *pAllocator
+)
+{
+    m_VkDevice      = Device;
+    m_pVkAllocator  = pAllocator;
+    m_TimelineValue = 0; // Nothing to wait for before the first frames
+
+    m_ThreadCommandPools.resize(NumThreads);
+    for (ThreadCommandPool &ThreadPool : m_ThreadCommandPools)
+    {
+        // No RESET_COMMAND_BUFFER_BIT - buffers are only reset together with their pool
+        VkCommandPoolCreateInfo CommandPoolInfo{};
+        CommandPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        CommandPoolInfo.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        CommandPoolInfo.queueFamilyIndex = QueueFamilyIndex;
+
+        if (vkCreateCommandPool(m_VkDevice, &CommandPoolInfo, m_pVkAllocator, &ThreadPool.CommandPool) !=
+            VK_SUCCESS)
+        {
+            VKL_CRITICAL("Failed to create frame VkCommandPool!");
+            exit(1);
+        }
+    }
+}
+
+void FrameContext::Shutdown()
+{
+    // Command buffers are freed with their pool
+    for (ThreadCommandPool &ThreadPool : m_ThreadCommandPools)
+    {
+        vkDestroyCommandPool(m_VkDevice, ThreadPool.CommandPool, m_pVkAllocator);
+    }
+    m_ThreadCommandPools.clear();
+}
+
+void FrameContext::Reset()
+{
+    for (ThreadCommandPool &ThreadPool : m_ThreadCommandPools)
+    {
+        if (ThreadPool.Primary.NumUsed == 0 && ThreadPool.Secondary.NumUsed == 0)
+        {
+            continue;
+        }
+        vkResetCommandPool(m_VkDevice, ThreadPool.CommandPool, 0);
+        ThreadPool.Primary.NumUsed   = 0;
+        ThreadPool.Secondary.NumUsed = 0;
+    }
+}
+
+VkCommandBuffer FrameContext::AcquireCommandBuffer(uint32_t ThreadIndex, VkCommandBufferLevel Level)
+{
+    ThreadCommandPool &ThreadPool = m_ThreadCommandPools[ThreadIndex];
+    CommandBufferList &List =
+        Level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ? ThreadPool.Primary : ThreadPool.Secondary;
+
+    if (List.NumUsed == List.CommandBuffers.size())
+    {
+        VkCommandBufferAllocateInfo CommandBufferInfo{};
+        CommandBufferInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        CommandBufferInfo.commandPool        = ThreadPool.CommandPool;
+        CommandBufferInfo.level              = Level;
+        CommandBufferInfo.commandBufferCount = 1;
+
+        VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(m_VkDevice, &CommandBufferInfo, &CommandBuffer) != VK_SUCCESS)
+        {
+            VKL_CRITICAL("Failed to allocate frame VkCommandBuffer!");
+            exit(1);
+        }
+        List.CommandBuffers.push_back(CommandBuffer);
+    }
+
+    return List.CommandBuffers[List.NumUsed++];
+}
+
+uint32_t FrameContext::GetNumAllocatedCommandBuffers() const
+{
+    size_t NumCommandBuffers = 0;
+    for (ThreadCommandPool const &ThreadPool : m_ThreadCommandPools)
+    {
+        NumCommandBuffers += ThreadPool.Primary.CommandBuffers.size();
+        NumCommandBuffers += ThreadPool.Secondary.CommandBuffers.size();
+    }
+    return static_cast<uint32_t>(NumCommandBuffers);
+}
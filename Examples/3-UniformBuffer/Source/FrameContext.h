@@ -0,0 +1,57 @@
+#ifndef VULKANLEARNING_FRAMECONTEXT
+#define VULKANLEARNING_FRAMECONTEXT
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Command memory of one frame in flight: transient pool per recording thread, reset as a whole
+// once GPU is done with the frame. Command buffers are recycled, not freed
+class FrameContext
+{
+public:
+    // Thread 0 is the main thread, workers go after it
+    void Init(
+        VkDevice                     Device,
+        uint32_t                     QueueFamilyIndex,
+        uint32_t                     NumThreads,
+        VkAllocationCallbacks const *pAllocator
+    );
+    void Shutdown();
+
+    // Everything recorded since previous Reset has to be finished by GPU
+    void Reset();
+
+    // Valid until next Reset. Threads may call it concurrently, each with own ThreadIndex
+    VkCommandBuffer AcquireCommandBuffer(uint32_t ThreadIndex, VkCommandBufferLevel Level);
+
+    // Graphics timeline value signaled by last submission of this frame
+    void     SetTimelineValue(uint64_t Value) { m_TimelineValue = Value; }
+    uint64_t GetTimelineValue() const { return m_TimelineValue; }
+
+    uint32_t GetNumAllocatedCommandBuffers() const;
+
+private:
+    struct CommandBufferList
+    {
+        std::vector<VkCommandBuffer> CommandBuffers;
+        uint32_t                     NumUsed = 0;
+    };
+
+    struct ThreadCommandPool
+    {
+        VkCommandPool     CommandPool = VK_NULL_HANDLE;
+        CommandBufferList Primary;
+        CommandBufferList Secondary;
+    };
+
+private:
+    VkDevice                     m_VkDevice     = VK_NULL_HANDLE;
+    VkAllocationCallbacks const *m_pVkAllocator = nullptr;
+
+    std::vector<ThreadCommandPool> m_ThreadCommandPools;
+
+    uint64_t m_TimelineValue = 0;
+};
+
+#endif // !VULKANLEARNING_FRAMECONTEXT
@@ -0,0 +1,27 @@
+#include "FrameLatencyTracker.h"
+
+#include <algorithm>
+
+void FrameLatencyTracker::OnSubmitted(uint64_t TimelineValue)
+{
+    m_Pending.push_back(PendingFrame{TimelineValue, m_InputTime});
+}
+
+void FrameLatencyTracker::OnCompleted(uint64_t CompletedValue)
+{
+    Clock::time_point const Now = Clock::now();
+    while (!m_Pending.empty() && m_Pending.front().TimelineValue <= CompletedValue)
+    {
+        std::chrono::duration<double, std::milli> const Latency = Now - m_Pending.front().InputTime;
+        m_Pending.pop_front();
+
+        m_NumFrames++;
+        m_TotalLatencyMs += Latency.count();
+        m_MaxLatencyMs = std::max(m_MaxLatencyMs, Latency.count());
+    }
+}
+
+double FrameLatencyTracker::GetAverageLatencyMs() const
+{
+    return m_NumFrames > 0 ? m_TotalLatencyMs / static_cast<double>(m_NumFrames) : 0.0;
+}
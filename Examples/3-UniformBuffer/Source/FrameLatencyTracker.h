@@ -0,0 +1,42 @@
+#ifndef VULKANLEARNING_FRAMELATENCYTRACKER
+#define VULKANLEARNING_FRAMELATENCYTRACKER
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+// Time from sampling input a frame is built from to GPU finishing that frame. Present is queued right behind
+// the frame's commands, so it's a close lower bound of input-to-present latency.
+// Completion is noticed only when polled - CPU-bound frames are overstated by up to one frame of CPU time
+class FrameLatencyTracker
+{
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    void OnInputSampled() { m_InputTime = Clock::now(); }
+
+    // Frame built from last sampled input is finished once graphics timeline reaches TimelineValue
+    void OnSubmitted(uint64_t TimelineValue);
+    void OnCompleted(uint64_t CompletedValue);
+
+    uint64_t GetNumFrames() const { return m_NumFrames; }
+    double   GetAverageLatencyMs() const;
+    double   GetMaxLatencyMs() const { return m_MaxLatencyMs; }
+
+private:
+    struct PendingFrame
+    {
+        uint64_t          TimelineValue = 0;
+        Clock::time_point InputTime;
+    };
+
+private:
+    Clock::time_point        m_InputTime = Clock::now();
+    std::deque<PendingFrame> m_Pending; // In order of submission
+
+    uint64_t m_NumFrames      = 0;
+    double   m_TotalLatencyMs = 0.0;
+    double   m_MaxLatencyMs   = 0.0;
+};
+
+#endif // !VULKANLEARNING_FRAMELATENCYTRACKER
@@ -0,0 +1,127 @@
+#include "FreeListAllocator.h"
+
+#include <algorithm>
+
+FreeListAllocator::FreeListAllocator(uint64_t Size) : m_Size{Size}
+{
+    if (Size != 0)
+    {
+        m_FreeRanges.push_back({0, Size});
+    }
+}
+
+std::optional<uint64_t> FreeListAllocator::Allocate(uint64_t Size, uint64_t Alignment)
+{
+    if (Size == 0)
+    {
+        return std::nullopt;
+    }
+    Alignment = std::max<uint64_t>(Alignment, 1);
+
+    for (size_t i = 0; i < m_FreeRanges.size(); ++i)
+    {
+        FreeRange const Range = m_FreeRanges[i];
+
+        uint64_t const AlignedOffset = ((Range.Offset + Alignment - 1) / Alignment) * Alignment;
+        uint64_t const Padding       = AlignedOffset - Range.Offset;
+        if (Padding + Size > Range.Size)
+        {
+            continue;
+        }
+
+        uint64_t const TailOffset = AlignedOffset + Size;
+        uint64_t const TailSize   = Range.Offset + Range.Size - TailOffset;
+
+        // Padding before aligned offset stays free
+        if (Padding != 0)
+        {
+            m_FreeRanges[i].Size = Padding;
+            if (TailSize != 0)
+            {
+                m_FreeRanges.insert(m_FreeRanges.begin() + i + 1, {TailOffset, TailSize});
+            }
+        }
+        else if (TailSize != 0)
+        {
+            m_FreeRanges[i] = {TailOffset, TailSize};
+        }
+        else
+        {
+            m_FreeRanges.erase(m_FreeRanges.begin() + i);
+        }
+
+        m_UsedSize += Size;
+        return AlignedOffset;
+    }
+
+    return std::nullopt;
+}
+
+void FreeListAllocator::Free(uint64_t Offset, uint64_t Size)
+{
+    if (Size == 0)
+    {
+        return;
+    }
+
+    auto Next = std::lower_bound(
+        m_FreeRanges.begin(),
+        m_FreeRanges.end(),
+        Offset,
+        [](FreeRange const &Range, uint64_t Value) { return Range.Offset < Value; }
+    );
+
+    bool const bMergeWithPrev =
+        Next != m_FreeRanges.begin() && (Next - 1)->Offset + (Next - 1)->Size == Offset;
+    bool const bMergeWithNext = Next != m_FreeRanges.end() && Offset + Size == Next->Offset;
+
+    if (bMergeWithPrev && bMergeWithNext)
+    {
+        (Next - 1)->Size += Size + Next->Size;
+        m_FreeRanges.erase(Next);
+    }
+    else if (bMergeWithPrev)
+    {
+        (Next - 1)->Size += Size;
+    }
+    else if (bMergeWithNext)
+    {
+        Next->Offset = Offset;
+        Next->Size += Size;
+    }
+    else
+    {
+        m_FreeRanges.insert(Next, {Offset, Size});
+    }
+
+    m_UsedSize -= Size;
+}
+
+void FreeListAllocator::Grow(uint64_t NewSize)
+{
+    if (NewSize <= m_Size)
+    {
+        return;
+    }
+
+    uint64_t const Added = NewSize - m_Size;
+    if (!m_FreeRanges.empty() && m_FreeRanges.back().Offset + m_FreeRanges.back().Size == m_Size)
+    {
+        m_FreeRanges.back().Size += Added;
+    }
+    else
+    {
+        m_FreeRanges.push_back({m_Size, Added});
+    }
+    m_Size = NewSize;
+}
+
+uint64_t FreeListAllocator::GetLargestFreeRange() const
+{
+    uint64_t Largest = 0;
+    for (FreeRange const &Range : m_FreeRanges)
+    {
+        Largest = std::max(Largest, Range.Size);
+    }
+    return Largest;
+}
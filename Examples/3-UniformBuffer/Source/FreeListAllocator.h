@@ -0,0 +1,41 @@
+#ifndef VULKANLEARNING_FREELISTALLOCATOR
+#define VULKANLEARNING_FREELISTALLOCATOR
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Manages offsets inside of a linear range [0, Size), doesn't own any memory itself
+class FreeListAllocator
+{
+public:
+    FreeListAllocator() = default;
+    explicit FreeListAllocator(uint64_t Size);
+
+    std::optional<uint64_t> Allocate(uint64_t Size, uint64_t Alignment);
+    void                    Free(uint64_t Offset, uint64_t Size);
+
+    // Appends free space at the end of range
+    void Grow(uint64_t NewSize);
+
+    uint64_t GetSize() const { return m_Size; }
+    uint64_t GetUsedSize() const { return m_UsedSize; }
+    uint64_t GetLargestFreeRange() const;
+    uint32_t GetNumFreeRanges() const { return static_cast<uint32_t>(m_FreeRanges.size()); }
+
+    bool IsEmpty() const { return m_UsedSize == 0; }
+
+private:
+    struct FreeRange
+    {
+        uint64_t Offset = 0;
+        uint64_t Size   = 0;
+    };
+
+    std::vector<FreeRange> m_FreeRanges; // sorted by Offset, neighbouring ranges are always merged
+
+    uint64_t m_Size     = 0;
+    uint64_t m_UsedSize = 0;
+};
+
+#endif // !VULKANLEARNING_FREELISTALLOCATOR
@@ -0,0 +1,290 @@
+#include "GeometryBuffer.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cstring>
+
+void GeometryBuffer::Init(
+    VkDevice                     Device,
+    DeviceMemoryAllocator       *Allocator,
+    UploadBatch                 *Upload,
+    DeletionQueue               *Deletion,
+    TimelineSemaphore           *GraphicsTimeline,
+    VkAllocationCallbacks const *pAllocator,
+    uint32_t                     VertexCapacity,
+    uint32_t                     IndexCapacity
+)
+{
+    m_VkDevice         = Device;
+    m_Allocator        = Allocator;
+    m_Upload           = Upload;
+    m_Deletion         = Deletion;
+    m_GraphicsTimeline = GraphicsTimeline;
+    m_pVkAllocator     = pAllocator;
+
+    InitElementBuffer(
+        m_VertexBuffer,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        sizeof(Vertex),
+        VertexCapacity
+    );
+    InitElementBuffer(
+        m_IndexBuffer,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        sizeof(IndexType),
+        IndexCapacity
+    );
+
+    VKL_TRACE("GeometryBuffer initialized: {} vertices, {} indices", VertexCapacity, IndexCapacity);
+}
+
+void GeometryBuffer::Shutdown()
+{
+    for (ElementBuffer *Buffer : {&m_VertexBuffer, &m_IndexBuffer})
+    {
+        m_Upload->ForgetBuffer(Buffer->Buffer);
+        vkDestroyBuffer(m_VkDevice, Buffer->Buffer, m_pVkAllocator);
+        m_Allocator->Free(Buffer->Allocation);
+        *Buffer = ElementBuffer{};
+    }
+    m_NumMeshes  = 0;
+    m_NextMeshId = 0;
+    m_FreeMeshIds.clear();
+
+    VKL_TRACE("GeometryBuffer shut down");
+}
+
+MeshHandle GeometryBuffer::AddMesh(std::vector<Vertex> const &Vertices, std::vector<IndexType> const &Indices)
+{
+    if (Vertices.empty() || Indices.empty())
+    {
+        VKL_WARN("Empty mesh is not added to GeometryBuffer");
+        return MeshHandle{};
+    }
+
+    uint32_t const NumVertices = static_cast<uint32_t>(Vertices.size());
+    uint32_t const NumIndices  = static_cast<uint32_t>(Indices.size());
+
+    uint32_t const FirstVertex = AllocateElements(m_VertexBuffer, NumVertices);
+    uint32_t const FirstIndex  = AllocateElements(m_IndexBuffer, NumIndices);
+
+    WriteElements(m_VertexBuffer, FirstVertex, Vertices.data(), NumVertices);
+    WriteElements(m_IndexBuffer, FirstIndex, Indices.data(), NumIndices);
+
+    m_NumMeshes++;
+
+    MeshHandle Mesh{};
+    Mesh.FirstIndex   = FirstIndex;
+    Mesh.VertexOffset = static_cast<int32_t>(FirstVertex);
+    Mesh.IndexCount   = NumIndices;
+    Mesh.VertexCount  = NumVertices;
+    if (m_FreeMeshIds.empty())
+    {
+        Mesh.Id = m_NextMeshId++;
+    }
+    else
+    {
+        Mesh.Id = m_FreeMeshIds.back();
+        m_FreeMeshIds.pop_back();
+    }
+    return Mesh;
+}
+
+void GeometryBuffer::RemoveMesh(MeshHandle &Mesh)
+{
+    if (!Mesh.IsValid())
+    {
+        return;
+    }
+
+    // Frames in flight may still draw it, ranges can be reused only after they are finished
+    m_Deletion->Push(
+        m_GraphicsTimeline->GetLastSubmittedValue(),
+        [this, Mesh]()
+        {
+            m_VertexBuffer.Ranges.Free(static_cast<uint64_t>(Mesh.VertexOffset), Mesh.VertexCount);
+            m_IndexBuffer.Ranges.Free(Mesh.FirstIndex, Mesh.IndexCount);
+        }
+    );
+    m_NumMeshes--;
+    m_FreeMeshIds.push_back(Mesh.Id); // Only names the mesh on CPU, can be reused right away
+
+    Mesh = MeshHandle{};
+}
+
+void GeometryBuffer::Bind(CommandRecorder &Recorder) const
+{
+    Recorder.BindVertexBuffer(0, m_VertexBuffer.Buffer);
+    Recorder.BindIndexBuffer(m_IndexBuffer.Buffer, 0, s_VkIndexType);
+}
+
+void GeometryBuffer::Draw(
+    CommandRecorder &Recorder, MeshHandle const &Mesh, uint32_t InstanceCount, uint32_t FirstInstance
+) const
+{
+    Recorder.DrawIndexed(Mesh.IndexCount, InstanceCount, Mesh.FirstIndex, Mesh.VertexOffset, FirstInstance);
+}
+
+VkDrawIndexedIndirectCommand GeometryBuffer::GetIndirectCommand(
+    MeshHandle const &Mesh, uint32_t InstanceCount, uint32_t FirstInstance
+)
+{
+    VkDrawIndexedIndirectCommand Command{};
+    Command.indexCount    = Mesh.IndexCount;
+    Command.instanceCount = InstanceCount;
+    Command.firstIndex    = Mesh.FirstIndex;
+    Command.vertexOffset  = Mesh.VertexOffset;
+    Command.firstInstance = FirstInstance;
+    return Command;
+}
+
+void GeometryBuffer::LogStats() const
+{
+    VKL_INFO(
+        "GeometryBuffer: {} meshes, {}/{} vertices, {}/{} indices, grown {} times, copied {} times",
+        m_NumMeshes,
+        m_VertexBuffer.Ranges.GetUsedSize(),
+        m_VertexBuffer.Ranges.GetSize(),
+        m_IndexBuffer.Ranges.GetUsedSize(),
+        m_IndexBuffer.Ranges.GetSize(),
+        m_NumGrowths,
+        m_NumReallocations
+    );
+}
+
+void GeometryBuffer::InitElementBuffer(
+    ElementBuffer &Buffer, VkBufferUsageFlags Usage, uint32_t ElementSize, uint32_t Capacity
+)
+{
+    Buffer.Usage       = Usage;
+    Buffer.ElementSize = ElementSize;
+    Buffer.Ranges      = FreeListAllocator(Capacity);
+    Buffer.Shadow.resize(static_cast<size_t>(Capacity) * ElementSize);
+
+    CreateBuffer(Buffer, Capacity);
+}
+
+uint32_t GeometryBuffer::AllocateElements(ElementBuffer &Buffer, uint32_t Count)
+{
+    std::optional<uint64_t> First = Buffer.Ranges.Allocate(Count, 1);
+    if (!First.has_value())
+    {
+        Grow(Buffer, static_cast<uint32_t>(Buffer.Ranges.GetSize()) + Count);
+        First = Buffer.Ranges.Allocate(Count, 1);
+    }
+
+    if (!First.has_value())
+    {
+        VKL_CRITICAL("Failed to allocate {} elements in GeometryBuffer!", Count);
+        exit(1);
+    }
+    return static_cast<uint32_t>(First.value());
+}
+
+void GeometryBuffer::WriteElements(ElementBuffer &Buffer, uint32_t First, void const *Data, uint32_t Count)
+{
+    size_t const Offset = static_cast<size_t>(First) * Buffer.ElementSize;
+    size_t const Size   = static_cast<size_t>(Count) * Buffer.ElementSize;
+
+    std::memcpy(Buffer.Shadow.data() + Offset, Data, Size);
+
+    // Frames in flight may read ranges of other meshes, so contents move to a new buffer, like on growth
+    if (IsReleasedToGraphics(Buffer))
+    {
+        Reallocate(Buffer);
+        m_NumReallocations++;
+
+        VKL_INFO("GeometryBuffer of {} bytes elements copied to a new buffer", Buffer.ElementSize);
+    }
+
+    // One copy of everything - separate copies of shadow and of the new range could overlap with no barrier
+    if (Buffer.bUploadShadow)
+    {
+        m_Upload->UploadBuffer(Buffer.Buffer, Buffer.Shadow.data(), Buffer.Shadow.size());
+        Buffer.bUploadShadow = false;
+    }
+    else
+    {
+        m_Upload->UploadBuffer(Buffer.Buffer, Data, Size, Offset);
+    }
+    Buffer.UploadSubmission = m_Upload->GetNumSubmissions();
+}
+
+bool GeometryBuffer::IsReleasedToGraphics(ElementBuffer const &Buffer) const
+{
+    // Same queue family - nothing is released
+    return m_Upload->IsOwnershipTransferRequired() && Buffer.UploadSubmission.has_value() &&
+           Buffer.UploadSubmission.value() != m_Upload->GetNumSubmissions();
+}
+
+void GeometryBuffer::Grow(ElementBuffer &Buffer, uint32_t MinCapacity)
+{
+    uint32_t const OldCapacity = static_cast<uint32_t>(Buffer.Ranges.GetSize());
+    uint32_t const NewCapacity = std::max(OldCapacity * 2, MinCapacity);
+
+    Buffer.Ranges.Grow(NewCapacity);
+    Buffer.Shadow.resize(static_cast<size_t>(NewCapacity) * Buffer.ElementSize);
+    Reallocate(Buffer);
+    m_NumGrowths++;
+
+    VKL_INFO(
+        "GeometryBuffer grown from {} to {} elements of {} bytes",
+        OldCapacity,
+        NewCapacity,
+        Buffer.ElementSize
+    );
+}
+
+void GeometryBuffer::Reallocate(ElementBuffer &Buffer)
+{
+    RetireBuffer(Buffer);
+    CreateBuffer(Buffer, static_cast<uint32_t>(Buffer.Ranges.GetSize()));
+
+    // Transfer queue doesn't own the old buffer anymore, so contents come from shadow copy instead of it
+    Buffer.bUploadShadow    = true;
+    Buffer.UploadSubmission = std::nullopt;
+}
+
+void GeometryBuffer::CreateBuffer(ElementBuffer &Buffer, uint32_t Capacity)
+{
+    VkBufferCreateInfo BufferCreateInfo{};
+    BufferCreateInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferCreateInfo.usage       = Buffer.Usage;
+    BufferCreateInfo.size        = static_cast<VkDeviceSize>(Capacity) * Buffer.ElementSize;
+    BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_VkDevice, &BufferCreateInfo, m_pVkAllocator, &Buffer.Buffer) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to create GeometryBuffer VkBuffer!");
+        exit(1);
+    }
+
+    VkMemoryRequirements BufferMemoryRequirements{};
+    vkGetBufferMemoryRequirements(m_VkDevice, Buffer.Buffer, &BufferMemoryRequirements);
+
+    Buffer.Allocation = m_Allocator->Allocate(BufferMemoryRequirements, MemoryUsage::GpuOnly);
+    vkBindBufferMemory(m_VkDevice, Buffer.Buffer, Buffer.Allocation.Memory, Buffer.Allocation.Offset);
+}
+
+void GeometryBuffer::RetireBuffer(ElementBuffer &Buffer)
+{
+    // Copies into the old buffer may be only recorded yet - they have to be submitted before it's destroyed
+    uint64_t const UploadValue = m_Upload->Submit();
+
+    // Frames recorded from now on bind the new buffer, none of them has to acquire the old one
+    m_Upload->ForgetBuffer(Buffer.Buffer);
+
+    m_Deletion->Push(
+        m_GraphicsTimeline->GetLastSubmittedValue(),
+        [this, OldBuffer = Buffer.Buffer, OldAllocation = Buffer.Allocation, UploadValue]() mutable
+        {
+            m_Upload->Wait(UploadValue); // Normally finished long ago
+            vkDestroyBuffer(m_VkDevice, OldBuffer, m_pVkAllocator);
+            m_Allocator->Free(OldAllocation);
+        }
+    );
+
+    Buffer.Buffer     = VK_NULL_HANDLE;
+    Buffer.Allocation = {};
+}
@@ -0,0 +1,133 @@
+#ifndef VULKANLEARNING_GEOMETRYBUFFER
+#define VULKANLEARNING_GEOMETRYBUFFER
+
+#include "CommandRecorder.h"
+#include "DeletionQueue.h"
+#include "DeviceMemoryAllocator.h"
+#include "FreeListAllocator.h"
+#include "TimelineSemaphore.h"
+#include "UploadBatch.h"
+#include "Vertex.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Ranges of mesh inside of GeometryBuffer. Indices are local to mesh, VertexOffset is added to them on draw
+struct MeshHandle
+{
+    uint32_t FirstIndex   = 0;
+    int32_t  VertexOffset = 0;
+    uint32_t IndexCount   = 0;
+    uint32_t VertexCount  = 0;
+
+    // Dense among live meshes, ids of removed ones are reused - small enough for sort keys
+    uint32_t Id = 0;
+
+    bool IsValid() const { return IndexCount != 0; }
+};
+
+// One vertex and one index buffer shared by all meshes, so they are bound once per frame.
+// Ranges are allocated in elements(vertices, indices), buffers grow by reallocation when full
+class GeometryBuffer
+{
+public:
+    using IndexType = uint16_t;
+
+    static constexpr VkIndexType s_VkIndexType           = VK_INDEX_TYPE_UINT16;
+    static constexpr uint32_t    s_DefaultVertexCapacity = 64 * 1024;
+    static constexpr uint32_t    s_DefaultIndexCapacity  = 256 * 1024;
+
+    // Retired buffers and freed ranges are kept until GraphicsTimeline passes frames that could use them
+    void Init(
+        VkDevice                     Device,
+        DeviceMemoryAllocator       *Allocator,
+        UploadBatch                 *Upload,
+        DeletionQueue               *Deletion,
+        TimelineSemaphore           *GraphicsTimeline,
+        VkAllocationCallbacks const *pAllocator,
+        uint32_t                     VertexCapacity = s_DefaultVertexCapacity,
+        uint32_t                     IndexCapacity  = s_DefaultIndexCapacity
+    );
+    void Shutdown();
+
+    // Data reaches GPU with next UploadBatch submission. Buffers released to graphics queue by earlier
+    // submissions are replaced by new ones - command buffers recorded with old ones have to be re-recorded
+    MeshHandle AddMesh(std::vector<Vertex> const &Vertices, std::vector<IndexType> const &Indices);
+    void       RemoveMesh(MeshHandle &Mesh);
+
+    void Bind(CommandRecorder &Recorder) const;
+    void Draw(
+        CommandRecorder  &Recorder,
+        MeshHandle const &Mesh,
+        uint32_t          InstanceCount = 1,
+        uint32_t          FirstInstance = 0
+    ) const;
+
+    // Same draw as Draw, to be written into indirect buffer
+    static VkDrawIndexedIndirectCommand GetIndirectCommand(
+        MeshHandle const &Mesh, uint32_t InstanceCount = 1, uint32_t FirstInstance = 0
+    );
+
+    VkBuffer GetVertexBuffer() const { return m_VertexBuffer.Buffer; }
+    VkBuffer GetIndexBuffer() const { return m_IndexBuffer.Buffer; }
+    uint32_t GetNumMeshes() const { return m_NumMeshes; }
+    uint32_t GetNumGrowths() const { return m_NumGrowths; }
+
+    void LogStats() const;
+
+private:
+    struct ElementBuffer
+    {
+        VkBuffer               Buffer = VK_NULL_HANDLE;
+        DeviceMemoryAllocation Allocation{};
+        VkBufferUsageFlags     Usage       = 0;
+        uint32_t               ElementSize = 0;
+        FreeListAllocator      Ranges; // In elements
+
+        // Copy of buffer contents, new buffer gets all of it with the first write
+        std::vector<char> Shadow;
+        bool              bUploadShadow = false;
+
+        // UploadBatch submission the last copies into buffer were recorded into. Once it's submitted, buffer
+        // belongs to graphics queue and transfer queue can't write it anymore
+        std::optional<uint64_t> UploadSubmission;
+    };
+
+    void InitElementBuffer(
+        ElementBuffer &Buffer, VkBufferUsageFlags Usage, uint32_t ElementSize, uint32_t Capacity
+    );
+
+    uint32_t AllocateElements(ElementBuffer &Buffer, uint32_t Count);
+    void     WriteElements(ElementBuffer &Buffer, uint32_t First, void const *Data, uint32_t Count);
+
+    bool IsReleasedToGraphics(ElementBuffer const &Buffer) const;
+
+    // Old buffer is retired, not destroyed - frames in flight may still read it
+    void Grow(ElementBuffer &Buffer, uint32_t MinCapacity);
+    void Reallocate(ElementBuffer &Buffer);
+
+    void CreateBuffer(ElementBuffer &Buffer, uint32_t Capacity);
+    void RetireBuffer(ElementBuffer &Buffer);
+
+private:
+    VkDevice                     m_VkDevice         = VK_NULL_HANDLE;
+    DeviceMemoryAllocator       *m_Allocator        = nullptr;
+    UploadBatch                 *m_Upload           = nullptr;
+    DeletionQueue               *m_Deletion         = nullptr;
+    TimelineSemaphore           *m_GraphicsTimeline = nullptr;
+    VkAllocationCallbacks const *m_pVkAllocator     = nullptr;
+
+    ElementBuffer m_VertexBuffer;
+    ElementBuffer m_IndexBuffer;
+
+    uint32_t m_NumMeshes        = 0;
+    uint32_t m_NumGrowths       = 0;
+    uint32_t m_NumReallocations = 0; // Writes after ownership was released
+
+    uint32_t              m_NextMeshId = 0;
+    std::vector<uint32_t> m_FreeMeshIds;
+};
+
+#endif // !VULKANLEARNING_GEOMETRYBUFFER
@@ -0,0 +1,270 @@
+#include "HostAllocationTracker.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+// Lives right before every pointer returned to the driver
+struct AllocationHeader
+{
+    size_t                  Size       = 0;
+    size_t                  Padding    = 0; // From the start of raw allocation to returned pointer
+    VkSystemAllocationScope Scope      = VK_SYSTEM_ALLOCATION_SCOPE_COMMAND;
+    bool                    bFromArena = false;
+};
+
+AllocationHeader *GetHeader(void *pMemory)
+{
+    return reinterpret_cast<AllocationHeader *>(static_cast<char *>(pMemory) - sizeof(AllocationHeader));
+}
+
+// Returned pointer is aligned to Alignment and has room for header before it
+uintptr_t GetAlignedAddress(uintptr_t RawAddress, size_t Alignment)
+{
+    uintptr_t const Address = RawAddress + sizeof(AllocationHeader);
+    return (Address + Alignment - 1) & ~(static_cast<uintptr_t>(Alignment) - 1);
+}
+} // namespace
+
+HostAllocationTracker::HostAllocationTracker() : m_CommandArena(std::make_unique<char[]>(s_CommandArenaSize))
+{
+    m_Callbacks.pUserData             = this;
+    m_Callbacks.pfnAllocation         = &HostAllocationTracker::Allocate;
+    m_Callbacks.pfnReallocation       = &HostAllocationTracker::Reallocate;
+    m_Callbacks.pfnFree               = &HostAllocationTracker::Free;
+    m_Callbacks.pfnInternalAllocation = &HostAllocationTracker::InternalAllocationNotification;
+    m_Callbacks.pfnInternalFree       = &HostAllocationTracker::InternalFreeNotification;
+}
+
+HostAllocationTracker::~HostAllocationTracker()
+{
+    if (m_NumCommandArenaAllocations > 0)
+    {
+        VKL_WARN("{} command scope host allocations were never freed!", m_NumCommandArenaAllocations);
+    }
+}
+
+HostAllocationScopeStats HostAllocationTracker::GetScopeStats(VkSystemAllocationScope Scope) const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_ScopesStats[Scope];
+}
+
+uint64_t HostAllocationTracker::GetNumAllocations() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    uint64_t NumAllocations = 0;
+    for (HostAllocationScopeStats const &ScopeStats : m_ScopesStats)
+    {
+        NumAllocations += ScopeStats.NumAllocations;
+    }
+    return NumAllocations;
+}
+
+void HostAllocationTracker::LogStats() const
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+
+    for (size_t i = 0; i < s_NumScopes; ++i)
+    {
+        HostAllocationScopeStats const &ScopeStats = m_ScopesStats[i];
+        VKL_INFO(
+            "Host memory {}: current {} B, peak {} B, {} allocations, {} frees",
+            ScopeToString(static_cast<VkSystemAllocationScope>(i)),
+            ScopeStats.CurrentBytes,
+            ScopeStats.PeakBytes,
+            ScopeStats.NumAllocations,
+            ScopeStats.NumFrees
+        );
+    }
+    VKL_INFO(
+        "Host memory internal(driver): current {} B, peak {} B, {} allocations",
+        m_InternalStats.CurrentBytes,
+        m_InternalStats.PeakBytes,
+        m_InternalStats.NumAllocations
+    );
+    VKL_INFO("Command scope arena: {} allocations didn't fit", m_NumCommandArenaFallbacks);
+}
+
+void *HostAllocationTracker::Allocate(
+    void *pUserData, size_t Size, size_t Alignment, VkSystemAllocationScope Scope
+)
+{
+    HostAllocationTracker *Tracker = static_cast<HostAllocationTracker *>(pUserData);
+
+    std::lock_guard<std::mutex> Lock(Tracker->m_Mutex);
+    return Tracker->AllocateLocked(Size, Alignment, Scope);
+}
+
+void *HostAllocationTracker::Reallocate(
+    void *pUserData, void *pOriginal, size_t Size, size_t Alignment, VkSystemAllocationScope Scope
+)
+{
+    HostAllocationTracker *Tracker = static_cast<HostAllocationTracker *>(pUserData);
+
+    std::lock_guard<std::mutex> Lock(Tracker->m_Mutex);
+    if (!pOriginal)
+    {
+        return Tracker->AllocateLocked(Size, Alignment, Scope);
+    }
+    if (Size == 0)
+    {
+        Tracker->FreeLocked(pOriginal);
+        return nullptr;
+    }
+
+    // Original stays untouched if new allocation fails
+    void *pMemory = Tracker->AllocateLocked(Size, Alignment, Scope);
+    if (pMemory)
+    {
+        std::memcpy(pMemory, pOriginal, std::min(Size, GetHeader(pOriginal)->Size));
+        Tracker->FreeLocked(pOriginal);
+    }
+    return pMemory;
+}
+
+void HostAllocationTracker::Free(void *pUserData, void *pMemory)
+{
+    if (!pMemory)
+    {
+        return;
+    }
+
+    HostAllocationTracker *Tracker = static_cast<HostAllocationTracker *>(pUserData);
+
+    std::lock_guard<std::mutex> Lock(Tracker->m_Mutex);
+    Tracker->FreeLocked(pMemory);
+}
+
+void HostAllocationTracker::InternalAllocationNotification(
+    void *pUserData, size_t Size, VkInternalAllocationType Type, VkSystemAllocationScope Scope
+)
+{
+    HostAllocationTracker *Tracker = static_cast<HostAllocationTracker *>(pUserData);
+
+    std::lock_guard<std::mutex> Lock(Tracker->m_Mutex);
+    HostAllocationScopeStats &Stats = Tracker->m_InternalStats;
+    Stats.CurrentBytes += Size;
+    Stats.PeakBytes = std::max(Stats.PeakBytes, Stats.CurrentBytes);
+    ++Stats.NumAllocations;
+}
+
+void HostAllocationTracker::InternalFreeNotification(
+    void *pUserData, size_t Size, VkInternalAllocationType Type, VkSystemAllocationScope Scope
+)
+{
+    HostAllocationTracker *Tracker = static_cast<HostAllocationTracker *>(pUserData);
+
+    std::lock_guard<std::mutex> Lock(Tracker->m_Mutex);
+    HostAllocationScopeStats &Stats = Tracker->m_InternalStats;
+    Stats.CurrentBytes -= std::min(Size, Stats.CurrentBytes);
+    ++Stats.NumFrees;
+}
+
+void *HostAllocationTracker::AllocateLocked(size_t Size, size_t Alignment, VkSystemAllocationScope Scope)
+{
+    if (Size == 0)
+    {
+        return nullptr;
+    }
+
+    // Header has to be aligned as well
+    Alignment = std::max(Alignment, alignof(AllocationHeader));
+
+    void *pMemory    = nullptr;
+    bool  bFromArena = false;
+    if (Scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND)
+    {
+        pMemory    = AllocateFromArena(Size, Alignment);
+        bFromArena = pMemory != nullptr;
+    }
+
+    if (!pMemory)
+    {
+        void *pRaw = std::malloc(sizeof(AllocationHeader) + Alignment - 1 + Size);
+        if (!pRaw)
+        {
+            return nullptr;
+        }
+        pMemory = reinterpret_cast<void *>(GetAlignedAddress(reinterpret_cast<uintptr_t>(pRaw), Alignment));
+
+        GetHeader(pMemory)->Padding = static_cast<char *>(pMemory) - static_cast<char *>(pRaw);
+    }
+
+    AllocationHeader *Header = GetHeader(pMemory);
+    Header->Size             = Size;
+    Header->Scope            = Scope;
+    Header->bFromArena       = bFromArena;
+
+    HostAllocationScopeStats &Stats = m_ScopesStats[Scope];
+    Stats.CurrentBytes += Size;
+    Stats.PeakBytes = std::max(Stats.PeakBytes, Stats.CurrentBytes);
+    ++Stats.NumAllocations;
+
+    return pMemory;
+}
+
+void HostAllocationTracker::FreeLocked(void *pMemory)
+{
+    AllocationHeader const *Header = GetHeader(pMemory);
+
+    HostAllocationScopeStats &Stats = m_ScopesStats[Header->Scope];
+    Stats.CurrentBytes -= Header->Size;
+    ++Stats.NumFrees;
+
+    if (Header->bFromArena)
+    {
+        if (--m_NumCommandArenaAllocations == 0)
+        {
+            m_CommandArenaOffset = 0;
+        }
+        return;
+    }
+
+    std::free(static_cast<char *>(pMemory) - Header->Padding);
+}
+
+void *HostAllocationTracker::AllocateFromArena(size_t Size, size_t Alignment)
+{
+    uintptr_t const ArenaAddress = reinterpret_cast<uintptr_t>(m_CommandArena.get());
+    uintptr_t const Address      = GetAlignedAddress(ArenaAddress + m_CommandArenaOffset, Alignment);
+    size_t const    NewOffset    = static_cast<size_t>(Address - ArenaAddress) + Size;
+    if (NewOffset > s_CommandArenaSize)
+    {
+        ++m_NumCommandArenaFallbacks;
+        return nullptr;
+    }
+
+    m_CommandArenaOffset = NewOffset;
+    ++m_NumCommandArenaAllocations;
+    return reinterpret_cast<void *>(Address);
+}
+
+char const *HostAllocationTracker::ScopeToString(VkSystemAllocationScope Scope) const
+{
+    switch (Scope)
+    {
+    case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+        return "command";
+
+    case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+        return "object";
+
+    case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+        return "cache";
+
+    case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+        return "device";
+
+    case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+        return "instance";
+
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef VULKANLEARNING_HOSTALLOCATIONTRACKER
+#define VULKANLEARNING_HOSTALLOCATIONTRACKER
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vulkan/vulkan.h>
+
+struct HostAllocationScopeStats
+{
+    size_t   CurrentBytes   = 0;
+    size_t   PeakBytes      = 0;
+    uint64_t NumAllocations = 0; // Reallocations included
+    uint64_t NumFrees       = 0;
+};
+
+// VkAllocationCallbacks that count driver host memory per VkSystemAllocationScope.
+// Command scope allocations live only during one Vulkan call, so they are bumped from arena
+class HostAllocationTracker
+{
+public:
+    static constexpr size_t s_CommandArenaSize = 256 * 1024;
+
+    HostAllocationTracker();
+    ~HostAllocationTracker();
+
+    HostAllocationTracker(HostAllocationTracker const &)            = delete;
+    HostAllocationTracker &operator=(HostAllocationTracker const &) = delete;
+
+    VkAllocationCallbacks const *GetCallbacks() const { return &m_Callbacks; }
+
+    HostAllocationScopeStats GetScopeStats(VkSystemAllocationScope Scope) const;
+    uint64_t                 GetNumAllocations() const;
+
+    void LogStats() const;
+
+private:
+    static constexpr size_t s_NumScopes = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+    static VKAPI_ATTR void *VKAPI_CALL Allocate(
+        void *pUserData, size_t Size, size_t Alignment, VkSystemAllocationScope Scope
+    );
+    static VKAPI_ATTR void *VKAPI_CALL Reallocate(
+        void *pUserData, void *pOriginal, size_t Size, size_t Alignment, VkSystemAllocationScope Scope
+    );
+    static VKAPI_ATTR void VKAPI_CALL Free(void *pUserData, void *pMemory);
+
+    static VKAPI_ATTR void VKAPI_CALL InternalAllocationNotification(
+        void *pUserData, size_t Size, VkInternalAllocationType Type, VkSystemAllocationScope Scope
+    );
+    static VKAPI_ATTR void VKAPI_CALL InternalFreeNotification(
+        void *pUserData, size_t Size, VkInternalAllocationType Type, VkSystemAllocationScope Scope
+    );
+
+    // Both expect m_Mutex to be locked
+    void *AllocateLocked(size_t Size, size_t Alignment, VkSystemAllocationScope Scope);
+    void  FreeLocked(void *pMemory);
+
+    void *AllocateFromArena(size_t Size, size_t Alignment);
+
+    char const *ScopeToString(VkSystemAllocationScope Scope) const;
+
+private:
+    VkAllocationCallbacks m_Callbacks{};
+
+    mutable std::mutex m_Mutex;
+
+    std::array<HostAllocationScopeStats, s_NumScopes> m_ScopesStats{};
+    HostAllocationScopeStats                           m_InternalStats{}; // Reported by driver, not ours
+
+    // Rewinds to the beginning once every allocation in it is freed
+    std::unique_ptr<char[]> m_CommandArena;
+    size_t                  m_CommandArenaOffset         = 0;
+    uint32_t                m_NumCommandArenaAllocations = 0;
+    uint64_t                m_NumCommandArenaFallbacks   = 0; // Didn't fit, went to malloc
+};
+
+#endif // !VULKANLEARNING_HOSTALLOCATIONTRACKER
@@ -0,0 +1,105 @@
+#include "IndirectDrawBuffer.h"
+
+#include "Log.h"
+
+#include <algorithm>
+
+void IndirectDrawBuffer::Init(
+    VkDevice                     Device,
+    DeviceMemoryAllocator       *Allocator,
+    DeletionQueue               *Deletion,
+    TimelineSemaphore           *GraphicsTimeline,
+    VkAllocationCallbacks const *pAllocator,
+    uint32_t                     Capacity
+)
+{
+    m_VkDevice         = Device;
+    m_Allocator        = Allocator;
+    m_Deletion         = Deletion;
+    m_GraphicsTimeline = GraphicsTimeline;
+    m_pVkAllocator     = pAllocator;
+
+    CreateBuffer(Capacity);
+}
+
+void IndirectDrawBuffer::Shutdown()
+{
+    vkDestroyBuffer(m_VkDevice, m_VkBuffer, m_pVkAllocator);
+    m_Allocator->Free(m_Allocation);
+
+    m_VkBuffer = VK_NULL_HANDLE;
+    m_Capacity = 0;
+}
+
+bool IndirectDrawBuffer::Reserve(uint32_t NumCommands)
+{
+    if (NumCommands <= m_Capacity)
+    {
+        return false;
+    }
+
+    uint32_t const NewCapacity = std::max(m_Capacity * 2, NumCommands);
+    VKL_INFO("IndirectDrawBuffer grown from {} to {} commands", m_Capacity, NewCapacity);
+
+    RetireBuffer();
+    CreateBuffer(NewCapacity);
+    return true;
+}
+
+VkDrawIndexedIndirectCommand *IndirectDrawBuffer::GetCommands() const
+{
+    return static_cast<VkDrawIndexedIndirectCommand *>(m_Allocation.MappedData);
+}
+
+uint32_t *IndirectDrawBuffer::GetDrawCounts() const
+{
+    return reinterpret_cast<uint32_t *>(GetCommands() + m_Capacity);
+}
+
+VkDeviceSize IndirectDrawBuffer::GetDrawCountOffset(uint32_t BatchIndex) const
+{
+    return m_Capacity * s_CommandStride + BatchIndex * sizeof(uint32_t);
+}
+
+void IndirectDrawBuffer::CreateBuffer(uint32_t Capacity)
+{
+    VkBufferCreateInfo BufferCreateInfo{};
+    BufferCreateInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferCreateInfo.usage       = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    BufferCreateInfo.size        = Capacity * (s_CommandStride + sizeof(uint32_t));
+    BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(m_VkDevice, &BufferCreateInfo, m_pVkAllocator, &m_VkBuffer) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to create IndirectDrawBuffer VkBuffer!");
+        exit(1);
+    }
+
+    VkMemoryRequirements BufferMemoryRequirements{};
+    vkGetBufferMemoryRequirements(m_VkDevice, m_VkBuffer, &BufferMemoryRequirements);
+
+    m_Allocation = m_Allocator->Allocate(BufferMemoryRequirements, MemoryUsage::PerFrameDynamic);
+    vkBindBufferMemory(m_VkDevice, m_VkBuffer, m_Allocation.Memory, m_Allocation.Offset);
+
+    if (!m_Allocation.MappedData)
+    {
+        VKL_CRITICAL("IndirectDrawBuffer memory is not host visible!");
+        exit(1);
+    }
+    m_Capacity = Capacity;
+}
+
+void IndirectDrawBuffer::RetireBuffer()
+{
+    m_Deletion->Push(
+        m_GraphicsTimeline->GetLastSubmittedValue(),
+        [this, OldBuffer = m_VkBuffer, OldAllocation = m_Allocation]() mutable
+        {
+            vkDestroyBuffer(m_VkDevice, OldBuffer, m_pVkAllocator);
+            m_Allocator->Free(OldAllocation);
+        }
+    );
+
+    m_VkBuffer   = VK_NULL_HANDLE;
+    m_Allocation = {};
+}
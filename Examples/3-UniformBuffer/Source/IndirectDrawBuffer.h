@@ -0,0 +1,58 @@
+#ifndef VULKANLEARNING_INDIRECTDRAWBUFFER
+#define VULKANLEARNING_INDIRECTDRAWBUFFER
+
+#include "DeletionQueue.h"
+#include "DeviceMemoryAllocator.h"
+#include "TimelineSemaphore.h"
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+// Host-visible buffer of VkDrawIndexedIndirectCommand records, written by CPU every frame before submit.
+// Draw counts of batches follow the commands, for vkCmdDrawIndexedIndirectCount. One per frame in flight
+class IndirectDrawBuffer
+{
+public:
+    static constexpr uint32_t     s_DefaultCapacity = 1024;
+    static constexpr VkDeviceSize s_CommandStride   = sizeof(VkDrawIndexedIndirectCommand);
+
+    void Init(
+        VkDevice                     Device,
+        DeviceMemoryAllocator       *Allocator,
+        DeletionQueue               *Deletion,
+        TimelineSemaphore           *GraphicsTimeline,
+        VkAllocationCallbacks const *pAllocator,
+        uint32_t                     Capacity = s_DefaultCapacity
+    );
+    void Shutdown();
+
+    // Contents are lost on growth. True - buffer was recreated, command buffers recorded with it are invalid
+    bool Reserve(uint32_t NumCommands);
+
+    VkDrawIndexedIndirectCommand *GetCommands() const;
+    uint32_t                     *GetDrawCounts() const; // Up to one per command
+
+    VkBuffer     GetBuffer() const { return m_VkBuffer; }
+    VkDeviceSize GetCommandOffset(uint32_t CommandIndex) const { return CommandIndex * s_CommandStride; }
+    VkDeviceSize GetDrawCountOffset(uint32_t BatchIndex) const;
+    uint32_t     GetCapacity() const { return m_Capacity; }
+
+private:
+    void CreateBuffer(uint32_t Capacity);
+
+    // Frames in flight may still read it
+    void RetireBuffer();
+
+private:
+    VkDevice                     m_VkDevice         = VK_NULL_HANDLE;
+    DeviceMemoryAllocator       *m_Allocator        = nullptr;
+    DeletionQueue               *m_Deletion         = nullptr;
+    TimelineSemaphore           *m_GraphicsTimeline = nullptr;
+    VkAllocationCallbacks const *m_pVkAllocator     = nullptr;
+
+    VkBuffer               m_VkBuffer = VK_NULL_HANDLE;
+    DeviceMemoryAllocation m_Allocation{};
+    uint32_t               m_Capacity = 0; // In commands
+};
+
+#endif // !VULKANLEARNING_INDIRECTDRAWBUFFER
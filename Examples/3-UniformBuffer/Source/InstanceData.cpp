@@ -0,0 +1,23 @@
+#include "InstanceData.h"
+
+VkVertexInputBindingDescription InstanceData::GetInputBindingDescription()
+{
+    VkVertexInputBindingDescription InputBindingDescription{};
+    InputBindingDescription.binding   = s_Binding;
+    InputBindingDescription.stride    = sizeof(InstanceData);
+    InputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    return InputBindingDescription;
+}
+
+std::array<VkVertexInputAttributeDescription, 4> InstanceData::GetInputAttributeDescriptions()
+{
+    std::array<VkVertexInputAttributeDescription, 4> ModelColumnAttributes{};
+    for (uint32_t Column = 0; Column < ModelColumnAttributes.size(); ++Column)
+    {
+        ModelColumnAttributes[Column].binding  = s_Binding;
+        ModelColumnAttributes[Column].location = s_FirstLocation + Column;
+        ModelColumnAttributes[Column].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+        ModelColumnAttributes[Column].offset   = offsetof(InstanceData, Model) + Column * sizeof(glm::vec4);
+    }
+    return ModelColumnAttributes;
+}
@@ -0,0 +1,21 @@
+#ifndef VULKANLEARNING_INSTANCEDATA
+#define VULKANLEARNING_INSTANCEDATA
+
+#include <array>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+// Per-instance vertex input, comes after Vertex attributes in instanced pipeline
+struct InstanceData
+{
+    glm::mat4 Model;
+
+    static constexpr uint32_t s_Binding       = 1;
+    static constexpr uint32_t s_FirstLocation = 2; // mat4 takes one location per column
+
+    static VkVertexInputBindingDescription GetInputBindingDescription();
+
+    static std::array<VkVertexInputAttributeDescription, 4> GetInputAttributeDescriptions();
+};
+
+#endif // !VULKANLEARNING_INSTANCEDATA
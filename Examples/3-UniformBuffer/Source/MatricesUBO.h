@@ -6,7 +6,6 @@
 
 struct MatricesUBO
 {
-    alignas(16) glm::mat4 Model{};
     alignas(16) glm::mat4 ProjectionView{};
 };
 
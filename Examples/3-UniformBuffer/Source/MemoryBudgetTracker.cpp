@@ -0,0 +1,125 @@
+#include "MemoryBudgetTracker.h"
+
+#include "Log.h"
+
+#include <algorithm>
+
+void MemoryBudgetTracker::Init(VkPhysicalDevice PhysicalDevice, bool bMemoryBudgetSupported)
+{
+    m_VkPhysicalDevice       = PhysicalDevice;
+    m_bMemoryBudgetSupported = bMemoryBudgetSupported;
+
+    m_AllocatedBytes.fill(0);
+    m_AllocatedBytesAtUpdate.fill(0);
+    m_bOverBudget.fill(false);
+
+    Update();
+
+    if (!m_bMemoryBudgetSupported)
+    {
+        VKL_WARN(
+            "VK_EXT_memory_budget not supported, budget is estimated as {}% of heap size",
+            s_FallbackBudgetPercent
+        );
+    }
+}
+
+void MemoryBudgetTracker::Update()
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT MemoryBudgetProperties{};
+    MemoryBudgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 MemoryProperties{};
+    MemoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    MemoryProperties.pNext = m_bMemoryBudgetSupported ? &MemoryBudgetProperties : nullptr;
+    vkGetPhysicalDeviceMemoryProperties2(m_VkPhysicalDevice, &MemoryProperties);
+
+    VkPhysicalDeviceMemoryProperties const &Properties = MemoryProperties.memoryProperties;
+
+    m_NumHeaps = Properties.memoryHeapCount;
+    for (uint32_t i = 0; i < m_NumHeaps; ++i)
+    {
+        HeapBudget &Heap = m_HeapsBudgets[i];
+        if (m_bMemoryBudgetSupported)
+        {
+            Heap.Usage  = MemoryBudgetProperties.heapUsage[i];
+            Heap.Budget = MemoryBudgetProperties.heapBudget[i];
+        }
+        else
+        {
+            Heap.Usage  = m_AllocatedBytes[i];
+            Heap.Budget = Properties.memoryHeaps[i].size / 100 * s_FallbackBudgetPercent;
+        }
+        m_AllocatedBytesAtUpdate[i] = m_AllocatedBytes[i];
+
+        bool const bOverBudget = Heap.Usage > Heap.Budget;
+        if (bOverBudget && !m_bOverBudget[i])
+        {
+            VKL_WARN("Memory heap {} is over budget: {}/{} bytes", i, Heap.Usage, Heap.Budget);
+        }
+        else if (!bOverBudget && m_bOverBudget[i])
+        {
+            VKL_INFO("Memory heap {} is back within budget: {}/{} bytes", i, Heap.Usage, Heap.Budget);
+        }
+        m_bOverBudget[i] = bOverBudget;
+    }
+}
+
+void MemoryBudgetTracker::NotifyAllocated(uint32_t HeapIndex, VkDeviceSize Size)
+{
+    m_AllocatedBytes[HeapIndex] += Size;
+}
+
+void MemoryBudgetTracker::NotifyFreed(uint32_t HeapIndex, VkDeviceSize Size)
+{
+    m_AllocatedBytes[HeapIndex] -= std::min(Size, m_AllocatedBytes[HeapIndex]);
+}
+
+bool MemoryBudgetTracker::CanAllocate(uint32_t HeapIndex, VkDeviceSize Size) const
+{
+    return GetHeapBudget(HeapIndex).Usage + Size <= GetSafeBudget(HeapIndex);
+}
+
+HeapBudget MemoryBudgetTracker::GetHeapBudget(uint32_t HeapIndex) const
+{
+    HeapBudget Heap = m_HeapsBudgets[HeapIndex];
+    if (!m_bMemoryBudgetSupported)
+    {
+        Heap.Usage = m_AllocatedBytes[HeapIndex];
+        return Heap;
+    }
+
+    // Driver doesn't know about allocations made after last query yet
+    VkDeviceSize const Allocated         = m_AllocatedBytes[HeapIndex];
+    VkDeviceSize const AllocatedAtUpdate = m_AllocatedBytesAtUpdate[HeapIndex];
+    if (Allocated >= AllocatedAtUpdate)
+    {
+        Heap.Usage += Allocated - AllocatedAtUpdate;
+    }
+    else
+    {
+        Heap.Usage -= std::min(Heap.Usage, AllocatedAtUpdate - Allocated);
+    }
+    return Heap;
+}
+
+void MemoryBudgetTracker::LogBudgets() const
+{
+    VKL_INFO("Memory budget({}):", m_bMemoryBudgetSupported ? "VK_EXT_memory_budget" : "estimated");
+    for (uint32_t i = 0; i < m_NumHeaps; ++i)
+    {
+        HeapBudget const Heap = GetHeapBudget(i);
+        VKL_INFO(
+            "Heap {}: {}/{} bytes used, {} bytes allocated by app",
+            i,
+            Heap.Usage,
+            Heap.Budget,
+            m_AllocatedBytes[i]
+        );
+    }
+}
+
+VkDeviceSize MemoryBudgetTracker::GetSafeBudget(uint32_t HeapIndex) const
+{
+    return m_HeapsBudgets[HeapIndex].Budget / 100 * s_SafeBudgetPercent;
+}
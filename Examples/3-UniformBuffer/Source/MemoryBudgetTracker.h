@@ -0,0 +1,58 @@
+#ifndef VULKANLEARNING_MEMORYBUDGETTRACKER
+#define VULKANLEARNING_MEMORYBUDGETTRACKER
+
+#include <array>
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+struct HeapBudget
+{
+    VkDeviceSize Usage  = 0;
+    VkDeviceSize Budget = 0; // Going above it makes driver page memory out
+};
+
+// Per heap usage and budget. With VK_EXT_memory_budget both come from driver, otherwise budget is estimated
+// from heap size and usage is what went through NotifyAllocated/NotifyFreed
+class MemoryBudgetTracker
+{
+public:
+    static constexpr VkDeviceSize s_FallbackBudgetPercent = 80; // Of heap size, without VK_EXT_memory_budget
+    static constexpr VkDeviceSize s_SafeBudgetPercent     = 90; // Leaves headroom for other processes
+
+    void Init(VkPhysicalDevice PhysicalDevice, bool bMemoryBudgetSupported);
+
+    // Driver values are only refreshed here, call once per frame
+    void Update();
+
+    void NotifyAllocated(uint32_t HeapIndex, VkDeviceSize Size);
+    void NotifyFreed(uint32_t HeapIndex, VkDeviceSize Size);
+
+    // Whether Size more bytes keep heap within safe part of its budget
+    bool CanAllocate(uint32_t HeapIndex, VkDeviceSize Size) const;
+
+    // Usage includes allocations made since last Update
+    HeapBudget GetHeapBudget(uint32_t HeapIndex) const;
+    uint32_t   GetNumHeaps() const { return m_NumHeaps; }
+
+    bool IsMemoryBudgetSupported() const { return m_bMemoryBudgetSupported; }
+
+    void LogBudgets() const;
+
+private:
+    VkDeviceSize GetSafeBudget(uint32_t HeapIndex) const;
+
+private:
+    VkPhysicalDevice m_VkPhysicalDevice       = VK_NULL_HANDLE;
+    bool             m_bMemoryBudgetSupported = false;
+    uint32_t         m_NumHeaps               = 0;
+
+    std::array<HeapBudget, VK_MAX_MEMORY_HEAPS> m_HeapsBudgets{}; // As of last Update
+
+    // Bytes allocated by us, total and at the moment of last Update
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_AllocatedBytes{};
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_AllocatedBytesAtUpdate{};
+
+    std::array<bool, VK_MAX_MEMORY_HEAPS> m_bOverBudget{}; // Warn only once heap crosses budget
+};
+
+#endif // !VULKANLEARNING_MEMORYBUDGETTRACKER
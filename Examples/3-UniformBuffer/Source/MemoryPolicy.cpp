@@ -0,0 +1,161 @@
+#include "MemoryPolicy.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <bitset>
+
+char const *MemoryUsageToString(MemoryUsage Usage)
+{
+    switch (Usage)
+    {
+    case MemoryUsage::GpuOnly:
+        return "GpuOnly";
+
+    case MemoryUsage::Upload:
+        return "Upload";
+
+    case MemoryUsage::Readback:
+        return "Readback";
+
+    case MemoryUsage::PerFrameDynamic:
+        return "PerFrameDynamic";
+
+    default:
+        return "Unknown";
+    }
+}
+
+void MemoryPolicy::Build(VkPhysicalDevice PhysicalDevice)
+{
+    vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &m_MemoryProperties);
+
+    for (size_t i = 0; i < m_RankedMemoryTypes.size(); ++i)
+    {
+        m_RankedMemoryTypes[i] = RankMemoryTypes(GetUsageRequirements(static_cast<MemoryUsage>(i)));
+        if (m_RankedMemoryTypes[i].empty())
+        {
+            VKL_CRITICAL("No memory type for {} usage!", MemoryUsageToString(static_cast<MemoryUsage>(i)));
+            exit(1);
+        }
+    }
+
+    LogPolicy();
+}
+
+std::vector<uint32_t> MemoryPolicy::GetCandidateMemoryTypes(MemoryUsage Usage, uint32_t TypeFilter) const
+{
+    std::vector<uint32_t> Candidates;
+    for (uint32_t MemoryTypeIndex : m_RankedMemoryTypes[static_cast<size_t>(Usage)])
+    {
+        if (TypeFilter & (1 << MemoryTypeIndex))
+        {
+            Candidates.push_back(MemoryTypeIndex);
+        }
+    }
+    return Candidates;
+}
+
+uint32_t MemoryPolicy::GetPreferredHeapIndex(MemoryUsage Usage) const
+{
+    uint32_t const MemoryTypeIndex = m_RankedMemoryTypes[static_cast<size_t>(Usage)].front();
+    return m_MemoryProperties.memoryTypes[MemoryTypeIndex].heapIndex;
+}
+
+bool MemoryPolicy::IsHostVisible(uint32_t MemoryTypeIndex) const
+{
+    VkMemoryPropertyFlags const Flags = m_MemoryProperties.memoryTypes[MemoryTypeIndex].propertyFlags;
+    return Flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+}
+
+void MemoryPolicy::LogPolicy() const
+{
+    for (size_t i = 0; i < m_RankedMemoryTypes.size(); ++i)
+    {
+        MemoryUsage const Usage           = static_cast<MemoryUsage>(i);
+        uint32_t const    MemoryTypeIndex = m_RankedMemoryTypes[i].front();
+        uint32_t const    HeapIndex       = GetPreferredHeapIndex(Usage);
+
+        VKL_TRACE(
+            "Memory usage {}: type {} (flags {:#x}), heap {} ({} MB), {} fallback types",
+            MemoryUsageToString(Usage),
+            MemoryTypeIndex,
+            m_MemoryProperties.memoryTypes[MemoryTypeIndex].propertyFlags,
+            HeapIndex,
+            m_MemoryProperties.memoryHeaps[HeapIndex].size / (1024 * 1024),
+            m_RankedMemoryTypes[i].size() - 1
+        );
+    }
+}
+
+MemoryPolicy::UsageRequirements MemoryPolicy::GetUsageRequirements(MemoryUsage Usage)
+{
+    // Mapped memory is never flushed or invalidated, so everything CPU touches has to be coherent
+    UsageRequirements Requirements{};
+    switch (Usage)
+    {
+    case MemoryUsage::GpuOnly:
+        Requirements.Preferred    = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        Requirements.NotPreferred = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT; // Leave small BAR heap alone
+        break;
+
+    case MemoryUsage::Upload:
+        Requirements.Required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        Requirements.NotPreferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        break;
+
+    case MemoryUsage::Readback:
+        Requirements.Required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        Requirements.Preferred = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        break;
+
+    case MemoryUsage::PerFrameDynamic:
+        // ReBAR and UMA expose DEVICE_LOCAL | HOST_VISIBLE, GPU reads it without going over PCIe
+        Requirements.Required  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        Requirements.Preferred = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        break;
+
+    default:
+        break;
+    }
+    return Requirements;
+}
+
+std::vector<uint32_t> MemoryPolicy::RankMemoryTypes(UsageRequirements const &Requirements) const
+{
+    // Never pick special purpose memory types
+    static constexpr VkMemoryPropertyFlags Excluded =
+        VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT | VK_MEMORY_PROPERTY_PROTECTED_BIT |
+        VK_MEMORY_PROPERTY_DEVICE_COHERENT_BIT_AMD | VK_MEMORY_PROPERTY_DEVICE_UNCACHED_BIT_AMD;
+
+    std::vector<std::pair<uint32_t, int32_t>> ScoredTypes; // {MemoryTypeIndex, Score}
+
+    for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; ++i)
+    {
+        VkMemoryPropertyFlags const Flags = m_MemoryProperties.memoryTypes[i].propertyFlags;
+        if ((Flags & Requirements.Required) != Requirements.Required || (Flags & Excluded))
+        {
+            continue;
+        }
+
+        int32_t Score = 0;
+        Score += 10 * static_cast<int32_t>(std::bitset<32>(Flags & Requirements.Preferred).count());
+        Score -= 10 * static_cast<int32_t>(std::bitset<32>(Flags & Requirements.NotPreferred).count());
+
+        ScoredTypes.push_back({i, Score});
+    }
+
+    // Same score - keep driver order, it lists faster types first
+    std::stable_sort(
+        ScoredTypes.begin(),
+        ScoredTypes.end(),
+        [](auto const &Lhs, auto const &Rhs) { return Lhs.second > Rhs.second; }
+    );
+
+    std::vector<uint32_t> Ranked;
+    for (auto const &[MemoryTypeIndex, Score] : ScoredTypes)
+    {
+        Ranked.push_back(MemoryTypeIndex);
+    }
+    return Ranked;
+}
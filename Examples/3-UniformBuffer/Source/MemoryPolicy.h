@@ -0,0 +1,58 @@
+#ifndef VULKANLEARNING_MEMORYPOLICY
+#define VULKANLEARNING_MEMORYPOLICY
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// What resource memory is going to be used for
+enum class MemoryUsage
+{
+    GpuOnly,         // Written once by transfer, read by GPU(vertex, index buffers)
+    Upload,          // Written by CPU, read by transfer(staging buffers)
+    Readback,        // Written by GPU, read by CPU
+    PerFrameDynamic, // Written by CPU every frame, read by GPU(uniform buffers)
+
+    Count
+};
+
+char const *MemoryUsageToString(MemoryUsage Usage);
+
+// Ranks memory types of physical device for each MemoryUsage, computed once per device
+class MemoryPolicy
+{
+public:
+    void Build(VkPhysicalDevice PhysicalDevice);
+
+    // Memory types from most to least preferable, only those allowed by TypeFilter
+    std::vector<uint32_t> GetCandidateMemoryTypes(MemoryUsage Usage, uint32_t TypeFilter) const;
+
+    // Heap of the most preferable memory type
+    uint32_t GetPreferredHeapIndex(MemoryUsage Usage) const;
+
+    bool IsHostVisible(uint32_t MemoryTypeIndex) const;
+
+    VkPhysicalDeviceMemoryProperties const &GetMemoryProperties() const { return m_MemoryProperties; }
+
+    void LogPolicy() const;
+
+private:
+    struct UsageRequirements
+    {
+        VkMemoryPropertyFlags Required     = 0;
+        VkMemoryPropertyFlags Preferred    = 0;
+        VkMemoryPropertyFlags NotPreferred = 0;
+    };
+
+    static UsageRequirements GetUsageRequirements(MemoryUsage Usage);
+
+    std::vector<uint32_t> RankMemoryTypes(UsageRequirements const &Requirements) const;
+
+private:
+    VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+
+    std::array<std::vector<uint32_t>, static_cast<size_t>(MemoryUsage::Count)> m_RankedMemoryTypes;
+};
+
+#endif // !VULKANLEARNING_MEMORYPOLICY
@@ -0,0 +1,17 @@
+#ifndef VULKANLEARNING_OBJECTPUSHCONSTANTS
+#define VULKANLEARNING_OBJECTPUSHCONSTANTS
+
+#include <cstdint>
+
+// Per-draw data, pushed before every draw. Only indices that stay the same while scene doesn't change -
+// object transform is read from ObjectsUBO, so cached command buffers don't go stale every frame.
+// Has to fit into 128 bytes - minimal maxPushConstantsSize
+struct ObjectPushConstants
+{
+    uint32_t ObjectIndex   = 0;
+    uint32_t MaterialIndex = 0;
+};
+
+static_assert(sizeof(ObjectPushConstants) <= 128, "ObjectPushConstants don't fit into guaranteed push range");
+
+#endif // !VULKANLEARNING_OBJECTPUSHCONSTANTS
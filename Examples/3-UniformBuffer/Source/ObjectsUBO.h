@@ -0,0 +1,16 @@
+#ifndef VULKANLEARNING_OBJECTSUBO
+#define VULKANLEARNING_OBJECTSUBO
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Transforms of all scene objects, written every frame. Draws pick theirs by pushed ObjectIndex, so command
+// buffers don't contain anything that changes when objects move
+struct ObjectsUBO
+{
+    static constexpr uint32_t s_MaxObjects = 256; // 16 KiB - minimal guaranteed maxUniformBufferRange
+
+    alignas(16) glm::mat4 Models[s_MaxObjects];
+};
+
+#endif // !VULKANLEARNING_OBJECTSUBO
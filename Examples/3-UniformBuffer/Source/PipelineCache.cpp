@@ -0,0 +1,173 @@
+#include "PipelineCache.h"
+
+#include "Log.h"
+
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+void PipelineCache::Init(
+    VkDevice                          Device,
+    VkPhysicalDeviceProperties const &DeviceProperties,
+    std::filesystem::path             FilePath,
+    VkAllocationCallbacks const      *pAllocator
+)
+{
+    m_VkDevice         = Device;
+    m_DeviceProperties = DeviceProperties;
+    m_FilePath         = std::move(FilePath);
+    m_pVkAllocator     = pAllocator;
+
+    std::vector<char> const InitialData = LoadData();
+
+    VkPipelineCacheCreateInfo CreateInfo{};
+    CreateInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    CreateInfo.initialDataSize = InitialData.size();
+    CreateInfo.pInitialData    = InitialData.empty() ? nullptr : InitialData.data();
+
+    VkResult Result = vkCreatePipelineCache(m_VkDevice, &CreateInfo, m_pVkAllocator, &m_VkPipelineCache);
+    if (Result != VK_SUCCESS && !InitialData.empty())
+    {
+        VKL_WARN("Pipeline cache data rejected by driver, starting empty");
+        CreateInfo.initialDataSize = 0;
+        CreateInfo.pInitialData    = nullptr;
+        Result = vkCreatePipelineCache(m_VkDevice, &CreateInfo, m_pVkAllocator, &m_VkPipelineCache);
+    }
+    if (Result != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to create VkPipelineCache!");
+        exit(1);
+    }
+
+    m_bWarm = CreateInfo.initialDataSize > 0;
+    if (m_bWarm)
+    {
+        VKL_INFO("Pipeline cache loaded: {} bytes from {}", InitialData.size(), m_FilePath.string());
+    }
+    else
+    {
+        VKL_INFO("Pipeline cache is empty, pipelines are compiled from scratch");
+    }
+}
+
+void PipelineCache::Shutdown()
+{
+    vkDestroyPipelineCache(m_VkDevice, m_VkPipelineCache, m_pVkAllocator);
+    m_VkPipelineCache = VK_NULL_HANDLE;
+}
+
+void PipelineCache::Save() const
+{
+    size_t DataSize = 0;
+    if (vkGetPipelineCacheData(m_VkDevice, m_VkPipelineCache, &DataSize, nullptr) != VK_SUCCESS)
+    {
+        VKL_WARN("Failed to get VkPipelineCache data, cache is not saved");
+        return;
+    }
+    std::vector<char> Data(DataSize);
+    if (vkGetPipelineCacheData(m_VkDevice, m_VkPipelineCache, &DataSize, Data.data()) != VK_SUCCESS)
+    {
+        VKL_WARN("Failed to get VkPipelineCache data, cache is not saved");
+        return;
+    }
+    Data.resize(DataSize);
+
+    FileHeader const Header = MakeHeader(Data);
+
+    std::filesystem::path TemporaryPath = m_FilePath;
+    TemporaryPath += ".tmp";
+    {
+        std::ofstream File(TemporaryPath, std::ios::binary | std::ios::trunc);
+        File.write(reinterpret_cast<char const *>(&Header), sizeof(Header));
+        File.write(Data.data(), static_cast<std::streamsize>(Data.size()));
+        File.flush();
+        if (!File)
+        {
+            VKL_WARN("Failed to write pipeline cache to {}", TemporaryPath.string());
+            return;
+        }
+    }
+
+    // Replaces the old file in one step - readers see either the old cache or the new one
+    std::error_code Error;
+    std::filesystem::rename(TemporaryPath, m_FilePath, Error);
+    if (Error)
+    {
+        VKL_WARN("Failed to replace {}: {}", m_FilePath.string(), Error.message());
+        std::filesystem::remove(TemporaryPath, Error);
+        return;
+    }
+    VKL_INFO("Pipeline cache saved: {} bytes to {}", Data.size(), m_FilePath.string());
+}
+
+PipelineCache::FileHeader PipelineCache::MakeHeader(std::vector<char> const &Data) const
+{
+    FileHeader Header{};
+    Header.Magic         = s_Magic;
+    Header.FileVersion   = s_FileVersion;
+    Header.VendorID      = m_DeviceProperties.vendorID;
+    Header.DeviceID      = m_DeviceProperties.deviceID;
+    Header.DriverVersion = m_DeviceProperties.driverVersion;
+    std::memcpy(Header.PipelineCacheUUID, m_DeviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+    Header.DataSize = Data.size();
+    Header.DataHash = Hash(Data);
+    return Header;
+}
+
+std::vector<char> PipelineCache::LoadData() const
+{
+    std::ifstream File(m_FilePath, std::ios::ate | std::ios::binary);
+    if (!File)
+    {
+        return {}; // First launch
+    }
+
+    size_t const FileSize = static_cast<size_t>(File.tellg());
+    FileHeader   Header{};
+    if (FileSize < sizeof(Header))
+    {
+        VKL_WARN("Pipeline cache {} is truncated, ignored", m_FilePath.string());
+        return {};
+    }
+
+    File.seekg(0);
+    File.read(reinterpret_cast<char *>(&Header), sizeof(Header));
+
+    std::vector<char> Data(FileSize - sizeof(Header));
+    File.read(Data.data(), static_cast<std::streamsize>(Data.size()));
+    if (!File || Header.Magic != s_Magic || Header.FileVersion != s_FileVersion ||
+        Header.DataSize != Data.size())
+    {
+        VKL_WARN("Pipeline cache {} has unknown format, ignored", m_FilePath.string());
+        return {};
+    }
+
+    // Driver would reject foreign data anyway, but not every driver validates it well
+    FileHeader const Expected = MakeHeader(Data);
+    if (Header.VendorID != Expected.VendorID || Header.DeviceID != Expected.DeviceID ||
+        Header.DriverVersion != Expected.DriverVersion ||
+        std::memcmp(Header.PipelineCacheUUID, Expected.PipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        VKL_INFO("Pipeline cache {} was made by another device or driver, ignored", m_FilePath.string());
+        return {};
+    }
+    if (Header.DataHash != Expected.DataHash)
+    {
+        VKL_WARN("Pipeline cache {} is corrupted, ignored", m_FilePath.string());
+        return {};
+    }
+    return Data;
+}
+
+uint64_t PipelineCache::Hash(std::vector<char> const &Data)
+{
+    // FNV-1a
+    uint64_t Value = 14695981039346656037ull;
+    for (char const Byte : Data)
+    {
+        Value ^= static_cast<uint8_t>(Byte);
+        Value *= 1099511628211ull;
+    }
+    return Value;
+}
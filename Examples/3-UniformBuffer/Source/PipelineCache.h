@@ -0,0 +1,64 @@
+#ifndef VULKANLEARNING_PIPELINECACHE
+#define VULKANLEARNING_PIPELINECACHE
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// VkPipelineCache kept on disk between launches. Data is stored behind own header identifying device and
+// driver it was produced by - data of another device, driver or file version is dropped, not handed to driver
+class PipelineCache
+{
+public:
+    void Init(
+        VkDevice                          Device,
+        VkPhysicalDeviceProperties const &DeviceProperties,
+        std::filesystem::path             FilePath,
+        VkAllocationCallbacks const      *pAllocator
+    );
+    void Shutdown();
+
+    // Written to temporary file first and renamed over the old one, so a crash never leaves it half-written
+    void Save() const;
+
+    VkPipelineCache Get() const { return m_VkPipelineCache; }
+
+    // Created from valid data on disk - pipelines creation is a warm start
+    bool IsWarm() const { return m_bWarm; }
+
+private:
+    struct FileHeader
+    {
+        uint32_t Magic         = 0;
+        uint32_t FileVersion   = 0;
+        uint32_t VendorID      = 0;
+        uint32_t DeviceID      = 0;
+        uint32_t DriverVersion = 0;
+        uint8_t  PipelineCacheUUID[VK_UUID_SIZE]{};
+        uint64_t DataSize = 0;
+        uint64_t DataHash = 0; // Catches truncated or corrupted data
+    };
+
+    static constexpr uint32_t s_Magic       = 0x504C4B56; // "VKLP"
+    static constexpr uint32_t s_FileVersion = 1;          // Bump when FileHeader changes
+
+    FileHeader MakeHeader(std::vector<char> const &Data) const;
+
+    // Empty if file is missing or doesn't match current device and driver
+    std::vector<char> LoadData() const;
+
+    static uint64_t Hash(std::vector<char> const &Data);
+
+private:
+    VkDevice                     m_VkDevice        = VK_NULL_HANDLE;
+    VkAllocationCallbacks const *m_pVkAllocator    = nullptr;
+    VkPipelineCache              m_VkPipelineCache = VK_NULL_HANDLE;
+
+    VkPhysicalDeviceProperties m_DeviceProperties{};
+    std::filesystem::path      m_FilePath;
+
+    bool m_bWarm = false;
+};
+
+#endif // !VULKANLEARNING_PIPELINECACHE
@@ -0,0 +1,91 @@
+#include "PresentPolicy.h"
+
+#include <algorithm>
+
+char const *PresentPolicyToString(PresentPolicy Policy)
+{
+    switch (Policy)
+    {
+    case PresentPolicy::LowLatency:
+        return "low-latency";
+
+    case PresentPolicy::VSync:
+        return "vsync";
+
+    case PresentPolicy::Uncapped:
+        return "uncapped";
+
+    case PresentPolicy::PowerSave:
+        return "power-save";
+
+    default:
+        return "unknown";
+    }
+}
+
+std::optional<PresentPolicy> PresentPolicyFromString(std::string_view String)
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(PresentPolicy::Count); ++i)
+    {
+        PresentPolicy const Policy = static_cast<PresentPolicy>(i);
+        if (String == PresentPolicyToString(Policy))
+        {
+            return Policy;
+        }
+    }
+    return std::nullopt;
+}
+
+char const *PresentModeToString(VkPresentModeKHR Mode)
+{
+    switch (Mode)
+    {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "IMMEDIATE";
+
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "MAILBOX";
+
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "FIFO";
+
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "FIFO_RELAXED";
+
+    default:
+        return "Unknown";
+    }
+}
+
+std::vector<VkPresentModeKHR> GetPreferredPresentModes(PresentPolicy Policy)
+{
+    switch (Policy)
+    {
+    case PresentPolicy::LowLatency:
+        return {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR};
+
+    case PresentPolicy::VSync:
+        return {VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR};
+
+    case PresentPolicy::Uncapped:
+        return {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR};
+
+    default:
+        return {VK_PRESENT_MODE_FIFO_KHR};
+    }
+}
+
+uint32_t GetDesiredSwapchainImagesCount(PresentPolicy Policy, VkPresentModeKHR Mode, uint32_t MinImageCount)
+{
+    // Power saving doesn't need to queue frames ahead of display
+    if (Policy == PresentPolicy::PowerSave)
+    {
+        return MinImageCount;
+    }
+    // Mailbox needs an image to replace on top of one shown and one being rendered
+    if (Mode == VK_PRESENT_MODE_MAILBOX_KHR)
+    {
+        return std::max(MinImageCount + 1, 3u);
+    }
+    return MinImageCount + 1;
+}
@@ -0,0 +1,31 @@
+#ifndef VULKANLEARNING_PRESENTPOLICY
+#define VULKANLEARNING_PRESENTPOLICY
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// How frames are handed to presentation engine, decides present mode and number of swapchain images
+enum class PresentPolicy
+{
+    LowLatency, // MAILBOX - newest frame is shown on vblank, no tearing, GPU runs uncapped
+    VSync,      // FIFO_RELAXED - capped to refresh rate, late frames tear instead of waiting a whole vblank
+    Uncapped,   // IMMEDIATE - no waiting for vblank at all, tears. For benchmarks
+    PowerSave,  // FIFO - capped to refresh rate with fewest images, CPU and GPU idle between frames
+
+    Count
+};
+
+char const                  *PresentPolicyToString(PresentPolicy Policy);
+std::optional<PresentPolicy> PresentPolicyFromString(std::string_view String);
+char const                  *PresentModeToString(VkPresentModeKHR Mode);
+
+// Present modes from most to least preferable. FIFO is always supported, so every list ends with it
+std::vector<VkPresentModeKHR> GetPreferredPresentModes(PresentPolicy Policy);
+
+// Before clamping to surface's maxImageCount
+uint32_t GetDesiredSwapchainImagesCount(PresentPolicy Policy, VkPresentModeKHR Mode, uint32_t MinImageCount);
+
+#endif // !VULKANLEARNING_PRESENTPOLICY
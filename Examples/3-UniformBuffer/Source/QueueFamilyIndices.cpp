@@ -1,6 +1,11 @@
 #include "QueueFamilyIndices.h"
 
-bool QueueFamilyIndices::IsComplete() const
+bool QueueFamilyIndices::IsComplete(bool bPresentationRequired) const
 {
-    return GraphicsFamily.has_value() && PresentationFamily.has_value();
+    return GraphicsFamily.has_value() && (PresentationFamily.has_value() || !bPresentationRequired);
+}
+
+bool QueueFamilyIndices::HasDedicatedTransferFamily() const
+{
+    return TransferFamily.has_value() && TransferFamily != GraphicsFamily;
 }
@@ -7,9 +7,11 @@
 struct QueueFamilyIndices
 {
     std::optional<uint32_t> GraphicsFamily;
-    std::optional<uint32_t> PresentationFamily;
+    std::optional<uint32_t> PresentationFamily; // Not selected in headless mode
+    std::optional<uint32_t> TransferFamily; // Transfer-only family if device has one, otherwise graphics
 
-    bool IsComplete() const;
+    bool IsComplete(bool bPresentationRequired) const;
+    bool HasDedicatedTransferFamily() const;
 };
 
 #endif // !VULKANLEARNING_QUEUEFAMILYINDICES
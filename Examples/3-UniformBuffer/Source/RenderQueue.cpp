@@ -0,0 +1,242 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+
+static_assert(
+    RenderQueue::s_PassBits + RenderQueue::s_PipelineBits + RenderQueue::s_DescriptorSetBits +
+            RenderQueue::s_MeshBits + RenderQueue::s_DepthBits ==
+        64,
+    "Sort key fields have to fill 64 bits exactly"
+);
+
+namespace
+{
+uint64_t MaskBits(uint64_t Value, uint32_t NumBits)
+{
+    return Value & ((uint64_t{1} << NumBits) - 1);
+}
+
+uint32_t GetBitWidth(uint64_t Value)
+{
+    uint32_t Width = 0;
+    for (; Value != 0; Value >>= 1)
+    {
+        Width++;
+    }
+    return Width;
+}
+
+struct KeyField
+{
+    uint32_t Shift   = 0;
+    uint32_t NumBits = 0;
+};
+
+// From least significant
+constexpr uint32_t s_NumKeyFields              = 5;
+constexpr KeyField s_KeyFields[s_NumKeyFields] = {
+    {0, RenderQueue::s_DepthBits},
+    {RenderQueue::s_DepthBits, RenderQueue::s_MeshBits},
+    {RenderQueue::s_DepthBits + RenderQueue::s_MeshBits, RenderQueue::s_DescriptorSetBits},
+    {RenderQueue::s_DepthBits + RenderQueue::s_MeshBits + RenderQueue::s_DescriptorSetBits,
+     RenderQueue::s_PipelineBits},
+    {64 - RenderQueue::s_PassBits, RenderQueue::s_PassBits}
+};
+
+// Bits of a field above its highest varying one are equal in all keys, so they are dropped and the rest of
+// the fields is moved down. Small ids and unused fields don't cost sort passes
+struct KeyCompaction
+{
+    uint64_t Masks[s_NumKeyFields]{};  // Kept bits of runs of fields moved by the same amount
+    uint32_t Shifts[s_NumKeyFields]{};
+    uint32_t NumRuns = 0;
+    uint32_t NumBits = 0;
+
+    explicit KeyCompaction(uint64_t VaryingBits)
+    {
+        uint32_t NumDroppedBits = 0;
+        for (KeyField const &Field : s_KeyFields)
+        {
+            uint32_t const NumKeptBits = GetBitWidth(MaskBits(VaryingBits >> Field.Shift, Field.NumBits));
+            if (NumKeptBits > 0)
+            {
+                uint64_t const Mask = MaskBits(~uint64_t{0}, NumKeptBits) << Field.Shift;
+                if (NumRuns > 0 && Shifts[NumRuns - 1] == NumDroppedBits)
+                {
+                    Masks[NumRuns - 1] |= Mask;
+                }
+                else
+                {
+                    Masks[NumRuns]  = Mask;
+                    Shifts[NumRuns] = NumDroppedBits;
+                    NumRuns++;
+                }
+            }
+            NumBits += NumKeptBits;
+            NumDroppedBits += Field.NumBits - NumKeptBits;
+        }
+    }
+
+    uint64_t Apply(uint64_t SortKey) const
+    {
+        uint64_t Key = 0;
+        for (uint32_t Run = 0; Run < NumRuns; ++Run)
+        {
+            Key |= (SortKey & Masks[Run]) >> Shifts[Run];
+        }
+        return Key;
+    }
+};
+} // namespace
+
+uint64_t RenderQueue::MakeSortKey(
+    DrawPass Pass, uint32_t PipelineId, uint32_t DescriptorSetId, uint32_t MeshId, float Depth
+)
+{
+    constexpr uint32_t MaxDepthBucket = (1u << s_DepthBits) - 1;
+
+    uint32_t DepthBucket = static_cast<uint32_t>(std::clamp(Depth, 0.0f, 1.0f) * MaxDepthBucket);
+    if (Pass == DrawPass::Transparent)
+    {
+        DepthBucket = MaxDepthBucket - DepthBucket;
+    }
+
+    uint64_t SortKey = MaskBits(static_cast<uint64_t>(Pass), s_PassBits);
+    SortKey          = (SortKey << s_PipelineBits) | MaskBits(PipelineId, s_PipelineBits);
+    SortKey          = (SortKey << s_DescriptorSetBits) | MaskBits(DescriptorSetId, s_DescriptorSetBits);
+    SortKey          = (SortKey << s_MeshBits) | MaskBits(MeshId, s_MeshBits);
+    SortKey          = (SortKey << s_DepthBits) | DepthBucket;
+    return SortKey;
+}
+
+uint32_t RenderQueue::GetPipelineId(uint64_t SortKey)
+{
+    return static_cast<uint32_t>(
+        MaskBits(SortKey >> (s_DescriptorSetBits + s_MeshBits + s_DepthBits), s_PipelineBits)
+    );
+}
+
+bool RenderQueue::HasSameDraws(std::vector<DrawPacket> const &Packets, std::vector<DrawPacket> const &Other)
+{
+    if (Packets.size() != Other.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < Packets.size(); ++i)
+    {
+        DrawPacket const &Packet      = Packets[i];
+        DrawPacket const &OtherPacket = Other[i];
+        if ((Packet.SortKey >> s_DepthBits) != (OtherPacket.SortKey >> s_DepthBits) ||
+            Packet.Mesh.Id != OtherPacket.Mesh.Id || Packet.Mesh.FirstIndex != OtherPacket.Mesh.FirstIndex ||
+            Packet.Mesh.VertexOffset != OtherPacket.Mesh.VertexOffset ||
+            Packet.Mesh.IndexCount != OtherPacket.Mesh.IndexCount ||
+            Packet.FirstInstance != OtherPacket.FirstInstance ||
+            Packet.InstanceCount != OtherPacket.InstanceCount || Packet.ObjectIndex != OtherPacket.ObjectIndex)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RenderQueue::Reserve(size_t NumPackets)
+{
+    m_Packets.reserve(NumPackets);
+    m_Scratch.reserve(NumPackets);
+    m_Entries.reserve(NumPackets);
+    m_EntriesScratch.reserve(NumPackets);
+}
+
+void RenderQueue::Clear()
+{
+    m_Packets.clear();
+    m_KeysOr  = 0;
+    m_KeysAnd = ~uint64_t{0};
+}
+
+void RenderQueue::Sort()
+{
+    size_t const   NumPackets  = m_Packets.size();
+    uint64_t const VaryingBits = m_KeysOr ^ m_KeysAnd;
+    if (NumPackets < 2 || VaryingBits == 0)
+    {
+        return;
+    }
+
+    KeyCompaction const Compaction(VaryingBits);
+    uint32_t const      NumIndexBits = GetBitWidth(NumPackets - 1);
+    if (Compaction.NumBits + NumIndexBits > 64)
+    {
+        // Key and index don't fit together - only with thousands of distinct ids in every field
+        std::stable_sort(
+            m_Packets.begin(),
+            m_Packets.end(),
+            [](DrawPacket const &Lhs, DrawPacket const &Rhs) { return Lhs.SortKey < Rhs.SortKey; }
+        );
+        return;
+    }
+
+    // Index below key makes entries unique, so sorting entries keeps packets with equal keys in order.
+    // Histograms of all digits in the same pass
+    uint32_t const NumDigits = (Compaction.NumBits + s_RadixBits - 1) / s_RadixBits;
+
+    std::array<std::array<uint32_t, s_NumBuckets>, s_MaxDigits> Histograms{};
+    m_Entries.resize(NumPackets);
+    for (size_t i = 0; i < NumPackets; ++i)
+    {
+        uint64_t const Key = Compaction.Apply(m_Packets[i].SortKey);
+        m_Entries[i]       = (Key << NumIndexBits) | i;
+        for (uint32_t Digit = 0; Digit < NumDigits; ++Digit)
+        {
+            Histograms[Digit][(Key >> (Digit * s_RadixBits)) & (s_NumBuckets - 1)]++;
+        }
+    }
+
+    // Compacted bits can still be equal in all keys(ids 0 and 2) - digits without varying bits are skipped
+    uint64_t const CompactedVaryingBits = Compaction.Apply(VaryingBits);
+    uint32_t       Digits[s_MaxDigits];
+    uint32_t       NumPasses = 0;
+    for (uint32_t Digit = 0; Digit < NumDigits; ++Digit)
+    {
+        if (((CompactedVaryingBits >> (Digit * s_RadixBits)) & (s_NumBuckets - 1)) != 0)
+        {
+            Digits[NumPasses++] = Digit;
+        }
+    }
+
+    m_EntriesScratch.resize(NumPackets);
+
+    uint64_t *Source      = m_Entries.data();
+    uint64_t *Destination = m_EntriesScratch.data();
+    for (uint32_t Pass = 0; Pass < NumPasses; ++Pass)
+    {
+        std::array<uint32_t, s_NumBuckets> &Histogram = Histograms[Digits[Pass]];
+
+        // Counts into offsets of buckets
+        uint32_t Offset = 0;
+        for (uint32_t &Count : Histogram)
+        {
+            uint32_t const BucketSize = Count;
+            Count                     = Offset;
+            Offset += BucketSize;
+        }
+
+        uint32_t const Shift = NumIndexBits + Digits[Pass] * s_RadixBits;
+        for (size_t i = 0; i < NumPackets; ++i)
+        {
+            uint64_t const Entry                                            = Source[i];
+            Destination[Histogram[(Entry >> Shift) & (s_NumBuckets - 1)]++] = Entry;
+        }
+        std::swap(Source, Destination);
+    }
+
+    // Packets are moved once, in sorted order
+    uint64_t const IndexMask = MaskBits(~uint64_t{0}, NumIndexBits);
+    m_Scratch.resize(NumPackets);
+    for (size_t i = 0; i < NumPackets; ++i)
+    {
+        m_Scratch[i] = m_Packets[Source[i] & IndexMask];
+    }
+    m_Packets.swap(m_Scratch);
+}
@@ -0,0 +1,90 @@
+#ifndef VULKANLEARNING_RENDERQUEUE
+#define VULKANLEARNING_RENDERQUEUE
+
+#include "GeometryBuffer.h"
+
+#include <cstdint>
+#include <vector>
+
+// Order of passes is order of drawing
+enum class DrawPass : uint8_t
+{
+    Opaque      = 0, // Front to back
+    Transparent = 1  // Back to front
+};
+
+// Everything needed to record one draw. Sorting packets by key groups draws with the same state together
+struct DrawPacket
+{
+    uint64_t   SortKey = 0;
+    MeshHandle Mesh;
+    uint32_t   FirstInstance = 0;
+    uint32_t   InstanceCount = 1;
+    uint32_t   ObjectIndex   = 0; // Whose per-draw data is pushed
+};
+
+// Draw packets of one frame. Filled every frame, then sorted by key before recording.
+// Key from most to least significant bits: pass | pipeline | descriptor set | mesh | depth bucket
+class RenderQueue
+{
+public:
+    static constexpr uint32_t s_PassBits          = 4;
+    static constexpr uint32_t s_PipelineBits      = 12;
+    static constexpr uint32_t s_DescriptorSetBits = 12;
+    static constexpr uint32_t s_MeshBits          = 16;
+    static constexpr uint32_t s_DepthBits         = 20;
+
+    // Ids are truncated to their number of bits. Depth is normalized to [0, 1], 0 - nearest
+    static uint64_t MakeSortKey(
+        DrawPass Pass, uint32_t PipelineId, uint32_t DescriptorSetId, uint32_t MeshId, float Depth
+    );
+
+    // Pass, pipeline and descriptor set - packets with equal state can be drawn by one indirect command
+    static uint64_t GetStateKey(uint64_t SortKey) { return SortKey >> (s_MeshBits + s_DepthBits); }
+    static uint32_t GetPipelineId(uint64_t SortKey);
+
+    // Same draws in the same order, depth buckets may differ
+    static bool HasSameDraws(std::vector<DrawPacket> const &Packets, std::vector<DrawPacket> const &Other);
+
+    void Reserve(size_t NumPackets);
+    void Clear();
+
+    void Push(
+        uint64_t          SortKey,
+        uint32_t          ObjectIndex,
+        MeshHandle const &Mesh,
+        uint32_t          FirstInstance = 0,
+        uint32_t          InstanceCount = 1
+    )
+    {
+        m_Packets.push_back(DrawPacket{SortKey, Mesh, FirstInstance, InstanceCount, ObjectIndex});
+        m_KeysOr |= SortKey;
+        m_KeysAnd &= SortKey;
+    }
+
+    // LSD radix sort, stable. Only key bits that differ between packets are sorted, packed together with
+    // packet index into 64 bits - passes move 8 bytes per packet, packets are moved once after them
+    void Sort();
+
+    std::vector<DrawPacket> const &GetPackets() const { return m_Packets; }
+
+private:
+    // Histograms of all digits take 8 KiB and stay in L1
+    static constexpr uint32_t s_RadixBits  = 8;
+    static constexpr uint32_t s_NumBuckets = 1 << s_RadixBits;
+    static constexpr uint32_t s_MaxDigits  = 64 / s_RadixBits;
+
+private:
+    std::vector<DrawPacket> m_Packets;
+
+    // Bits set in any key and in all keys - their difference is bits that can change the order
+    uint64_t m_KeysOr  = 0;
+    uint64_t m_KeysAnd = ~uint64_t{0};
+
+    // Kept between frames, so sorting doesn't allocate
+    std::vector<DrawPacket> m_Scratch;
+    std::vector<uint64_t>   m_Entries; // Compacted key | packet index
+    std::vector<uint64_t>   m_EntriesScratch;
+};
+
+#endif // !VULKANLEARNING_RENDERQUEUE
@@ -0,0 +1,44 @@
+#include "ResizeController.h"
+
+#include <algorithm>
+
+void ResizeController::Init(int Width, int Height, double MinIntervalMs)
+{
+    m_Width         = Width;
+    m_Height        = Height;
+    m_MinIntervalMs = MinIntervalMs;
+
+    m_LastRebuildTime = Clock::now();
+    m_bRebuildPending = false;
+}
+
+void ResizeController::OnResized(int Width, int Height)
+{
+    m_Width           = Width;
+    m_Height          = Height;
+    m_bRebuildPending = true;
+    m_NumEvents++;
+}
+
+bool ResizeController::ShouldRebuild() const
+{
+    if (!m_bRebuildPending || IsMinimized())
+    {
+        return false;
+    }
+    std::chrono::duration<double, std::milli> const SinceLastRebuild = Clock::now() - m_LastRebuildTime;
+    return SinceLastRebuild.count() >= GetIntervalMs();
+}
+
+void ResizeController::OnRebuilt(double RebuildTimeMs)
+{
+    m_LastRebuildTimeMs = RebuildTimeMs;
+    m_LastRebuildTime   = Clock::now();
+    m_bRebuildPending   = false;
+    m_NumRebuilds++;
+}
+
+double ResizeController::GetIntervalMs() const
+{
+    return std::max(m_MinIntervalMs, m_LastRebuildTimeMs * s_RebuildTimeFactor);
+}
@@ -0,0 +1,51 @@
+#ifndef VULKANLEARNING_RESIZECONTROLLER
+#define VULKANLEARNING_RESIZECONTROLLER
+
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+// Coalesces framebuffer size events of the window - during a drag swapchain is rebuilt at most once per
+// interval instead of once per event. Frames in between are rendered at the old extent and scaled by
+// presentation engine
+class ResizeController
+{
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    void Init(int Width, int Height, double MinIntervalMs);
+
+    void OnResized(int Width, int Height);
+    void RequestRebuild() { m_bRebuildPending = true; } // Swapchain reported SUBOPTIMAL
+
+    bool IsMinimized() const { return m_Width == 0 || m_Height == 0; }
+    bool IsRebuildPending() const { return m_bRebuildPending; }
+
+    // Rebuild is pending and interval since the last one elapsed, never while minimized
+    bool ShouldRebuild() const;
+
+    // Slow rebuilds stretch the interval, so they take a bounded share of frame time during a drag
+    void OnRebuilt(double RebuildTimeMs);
+
+    std::pair<int, int> GetFramebufferSize() const { return {m_Width, m_Height}; }
+    double              GetIntervalMs() const;
+
+    uint64_t GetNumEvents() const { return m_NumEvents; }
+    uint64_t GetNumRebuilds() const { return m_NumRebuilds; }
+
+private:
+    static constexpr double s_RebuildTimeFactor = 4.0;
+
+    int m_Width  = 0;
+    int m_Height = 0;
+
+    double            m_MinIntervalMs     = 0.0;
+    double            m_LastRebuildTimeMs = 0.0;
+    Clock::time_point m_LastRebuildTime   = Clock::now();
+    bool              m_bRebuildPending   = false;
+
+    uint64_t m_NumEvents   = 0;
+    uint64_t m_NumRebuilds = 0;
+};
+
+#endif // !VULKANLEARNING_RESIZECONTROLLER
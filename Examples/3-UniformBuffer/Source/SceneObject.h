@@ -0,0 +1,19 @@
+#ifndef VULKANLEARNING_SCENEOBJECT
+#define VULKANLEARNING_SCENEOBJECT
+
+#include "GeometryBuffer.h"
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Something drawn every frame. With InstanceCount > 0 it's drawn by instanced pipeline,
+// instance transforms are applied on top of Model
+struct SceneObject
+{
+    MeshHandle Mesh;
+    glm::mat4  Model{1.0f};
+    uint32_t   MaterialIndex = 0;
+    uint32_t   InstanceCount = 0;
+};
+
+#endif // !VULKANLEARNING_SCENEOBJECT
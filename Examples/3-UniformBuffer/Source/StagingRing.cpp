@@ -0,0 +1,94 @@
+#include "StagingRing.h"
+
+#include <algorithm>
+
+void StagingRing::Init(VkBuffer Buffer, void *MappedData, VkDeviceSize Size)
+{
+    m_Buffer     = Buffer;
+    m_MappedData = static_cast<char *>(MappedData);
+    m_Size       = Size;
+
+    m_Head = 0;
+    m_Tail = 0;
+    m_Pending.clear();
+    m_bHasUnretired = false;
+}
+
+std::optional<StagingRegion> StagingRing::Allocate(VkDeviceSize Size, VkDeviceSize Alignment)
+{
+    if (Size == 0 || Size > m_Size)
+    {
+        return std::nullopt;
+    }
+    Alignment = std::max<VkDeviceSize>(Alignment, 1);
+
+    bool const bEmpty = IsEmpty();
+    if (bEmpty)
+    {
+        m_Head = 0;
+        m_Tail = 0;
+    }
+
+    VkDeviceSize Offset = ((m_Head + Alignment - 1) / Alignment) * Alignment;
+
+    if (bEmpty || m_Head > m_Tail)
+    {
+        // Free space is [Head, Size) and [0, Tail)
+        if (Offset + Size > m_Size)
+        {
+            if (bEmpty || Size > m_Tail)
+            {
+                return std::nullopt;
+            }
+            Offset = 0; // Wrap around, end of buffer stays unused until Tail passes it
+        }
+    }
+    else if (Offset + Size > m_Tail) // Free space is [Head, Tail), Head == Tail - ring is full
+    {
+        return std::nullopt;
+    }
+
+    m_Head          = Offset + Size;
+    m_bHasUnretired = true;
+
+    StagingRegion Region{};
+    Region.Buffer     = m_Buffer;
+    Region.Offset     = Offset;
+    Region.Size       = Size;
+    Region.MappedData = m_MappedData + Offset;
+    return Region;
+}
+
+void StagingRing::Retire(uint64_t Value)
+{
+    if (!m_bHasUnretired)
+    {
+        return;
+    }
+    m_Pending.push_back({m_Head, Value});
+    m_bHasUnretired = false;
+}
+
+void StagingRing::Reclaim(uint64_t CompletedValue)
+{
+    while (!m_Pending.empty() && m_Pending.front().Value <= CompletedValue)
+    {
+        m_Tail = m_Pending.front().End;
+        m_Pending.pop_front();
+    }
+
+    if (IsEmpty())
+    {
+        m_Head = 0;
+        m_Tail = 0;
+    }
+}
+
+std::optional<uint64_t> StagingRing::GetOldestPendingValue() const
+{
+    if (m_Pending.empty())
+    {
+        return std::nullopt;
+    }
+    return m_Pending.front().Value;
+}
@@ -0,0 +1,60 @@
+#ifndef VULKANLEARNING_STAGINGRING
+#define VULKANLEARNING_STAGINGRING
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vulkan/vulkan.h>
+
+struct StagingRegion
+{
+    VkBuffer     Buffer     = VK_NULL_HANDLE;
+    VkDeviceSize Offset     = 0;
+    VkDeviceSize Size       = 0;
+    void        *MappedData = nullptr; // Already offset
+};
+
+// Hands out space of persistently mapped staging buffer in a circular manner.
+// Space comes back once the value it was retired with is completed
+class StagingRing
+{
+public:
+    static constexpr VkDeviceSize s_DefaultSize      = 16ull * 1024 * 1024;
+    static constexpr VkDeviceSize s_DefaultAlignment = 16;
+
+    void Init(VkBuffer Buffer, void *MappedData, VkDeviceSize Size);
+
+    std::optional<StagingRegion> Allocate(VkDeviceSize Size, VkDeviceSize Alignment = s_DefaultAlignment);
+
+    // Everything allocated since last Retire will be in use until Value is completed
+    void Retire(uint64_t Value);
+    void Reclaim(uint64_t CompletedValue);
+
+    bool                    HasPendingRegions() const { return !m_Pending.empty(); }
+    std::optional<uint64_t> GetOldestPendingValue() const;
+
+    VkBuffer     GetBuffer() const { return m_Buffer; }
+    VkDeviceSize GetSize() const { return m_Size; }
+
+private:
+    struct PendingRegion
+    {
+        VkDeviceSize End   = 0;
+        uint64_t     Value = 0;
+    };
+
+    bool IsEmpty() const { return m_Pending.empty() && !m_bHasUnretired; }
+
+private:
+    VkBuffer     m_Buffer     = VK_NULL_HANDLE;
+    char        *m_MappedData = nullptr;
+    VkDeviceSize m_Size       = 0;
+
+    VkDeviceSize m_Head = 0; // Next allocation starts here
+    VkDeviceSize m_Tail = 0; // Start of oldest region still in use
+
+    bool                      m_bHasUnretired = false;
+    std::deque<PendingRegion> m_Pending;
+};
+
+#endif // !VULKANLEARNING_STAGINGRING
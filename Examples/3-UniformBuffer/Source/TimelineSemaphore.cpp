@@ -0,0 +1,64 @@
+#include "TimelineSemaphore.h"
+
+#include "Log.h"
+
+void TimelineSemaphore::Create(VkDevice Device, VkAllocationCallbacks const *pAllocator)
+{
+    m_VkDevice     = Device;
+    m_pVkAllocator = pAllocator;
+
+    VkSemaphoreTypeCreateInfo SemaphoreTypeInfo{};
+    SemaphoreTypeInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    SemaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    SemaphoreTypeInfo.initialValue  = 0;
+
+    VkSemaphoreCreateInfo SemaphoreInfo{};
+    SemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    SemaphoreInfo.pNext = &SemaphoreTypeInfo;
+
+    if (vkCreateSemaphore(m_VkDevice, &SemaphoreInfo, m_pVkAllocator, &m_VkSemaphore) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to create timeline VkSemaphore!");
+        exit(1);
+    }
+
+    m_LastSubmittedValue = 0;
+    m_CompletedValue     = 0;
+}
+
+void TimelineSemaphore::Destroy()
+{
+    vkDestroySemaphore(m_VkDevice, m_VkSemaphore, m_pVkAllocator);
+    m_VkSemaphore = VK_NULL_HANDLE;
+}
+
+uint64_t TimelineSemaphore::GetCompletedValue()
+{
+    if (m_CompletedValue < m_LastSubmittedValue)
+    {
+        vkGetSemaphoreCounterValue(m_VkDevice, m_VkSemaphore, &m_CompletedValue);
+    }
+    return m_CompletedValue;
+}
+
+bool TimelineSemaphore::IsComplete(uint64_t Value)
+{
+    return Value <= m_CompletedValue || Value <= GetCompletedValue();
+}
+
+void TimelineSemaphore::Wait(uint64_t Value)
+{
+    if (IsComplete(Value))
+    {
+        return;
+    }
+
+    VkSemaphoreWaitInfo WaitInfo{};
+    WaitInfo.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    WaitInfo.semaphoreCount = 1;
+    WaitInfo.pSemaphores    = &m_VkSemaphore;
+    WaitInfo.pValues        = &Value;
+    vkWaitSemaphores(m_VkDevice, &WaitInfo, UINT64_MAX);
+
+    m_CompletedValue = Value;
+}
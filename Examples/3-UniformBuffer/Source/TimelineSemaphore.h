@@ -0,0 +1,34 @@
+#ifndef VULKANLEARNING_TIMELINESEMAPHORE
+#define VULKANLEARNING_TIMELINESEMAPHORE
+
+#include <cstdint>
+#include <vulkan/vulkan.h>
+
+// 64-bit clock of one queue: every submission signals next value, "is GPU done with X" is a comparison
+class TimelineSemaphore
+{
+public:
+    void Create(VkDevice Device, VkAllocationCallbacks const *pAllocator);
+    void Destroy();
+
+    VkSemaphore Get() const { return m_VkSemaphore; }
+
+    // Value the next submission has to signal
+    uint64_t ReserveNextValue() { return ++m_LastSubmittedValue; }
+    uint64_t GetLastSubmittedValue() const { return m_LastSubmittedValue; }
+
+    // Queries device only if cached value is not enough
+    uint64_t GetCompletedValue();
+    bool     IsComplete(uint64_t Value);
+    void     Wait(uint64_t Value);
+
+private:
+    VkDevice                     m_VkDevice     = VK_NULL_HANDLE;
+    VkAllocationCallbacks const *m_pVkAllocator = nullptr;
+    VkSemaphore                  m_VkSemaphore  = VK_NULL_HANDLE;
+
+    uint64_t m_LastSubmittedValue = 0;
+    uint64_t m_CompletedValue     = 0;
+};
+
+#endif // !VULKANLEARNING_TIMELINESEMAPHORE
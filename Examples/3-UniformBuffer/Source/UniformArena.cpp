@@ -0,0 +1,31 @@
+#include "UniformArena.h"
+
+#include <algorithm>
+
+void UniformArena::Init(VkBuffer Buffer, void *MappedData, VkDeviceSize Size, VkDeviceSize Alignment)
+{
+    m_Buffer     = Buffer;
+    m_MappedData = static_cast<char *>(MappedData);
+    m_Size       = Size;
+    m_Alignment  = std::max<VkDeviceSize>(Alignment, 1);
+
+    m_Head         = 0;
+    m_PeakUsedSize = 0;
+}
+
+std::optional<UniformRegion> UniformArena::Allocate(VkDeviceSize Size)
+{
+    VkDeviceSize const Offset = ((m_Head + m_Alignment - 1) / m_Alignment) * m_Alignment;
+    if (Size == 0 || Offset + Size > m_Size)
+    {
+        return std::nullopt;
+    }
+
+    m_Head         = Offset + Size;
+    m_PeakUsedSize = std::max(m_PeakUsedSize, m_Head);
+
+    UniformRegion Region{};
+    Region.DynamicOffset = static_cast<uint32_t>(Offset);
+    Region.MappedData    = m_MappedData + Offset;
+    return Region;
+}
@@ -0,0 +1,60 @@
+#ifndef VULKANLEARNING_UNIFORMARENA
+#define VULKANLEARNING_UNIFORMARENA
+
+#include <cstdint>
+#include <optional>
+#include <vulkan/vulkan.h>
+
+struct UniformRegion
+{
+    uint32_t DynamicOffset = 0; // For vkCmdBindDescriptorSets
+    void    *MappedData    = nullptr;
+};
+
+// Bump allocator over persistently mapped uniform buffer of one frame in flight. Blocks are referenced
+// by dynamic offsets of VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, so one descriptor set serves all of them
+class UniformArena
+{
+public:
+    static constexpr VkDeviceSize s_DefaultSize = 64 * 1024;
+
+    // Alignment - minUniformBufferOffsetAlignment of device
+    void Init(VkBuffer Buffer, void *MappedData, VkDeviceSize Size, VkDeviceSize Alignment);
+
+    // Previous submission of the frame has to be finished
+    void Reset() { m_Head = 0; }
+
+    std::optional<UniformRegion> Allocate(VkDeviceSize Size);
+
+    template <typename T>
+    std::optional<uint32_t> Write(T const &Data);
+
+    VkBuffer     GetBuffer() const { return m_Buffer; }
+    VkDeviceSize GetSize() const { return m_Size; }
+    VkDeviceSize GetUsedSize() const { return m_Head; }
+    VkDeviceSize GetPeakUsedSize() const { return m_PeakUsedSize; }
+
+private:
+    VkBuffer     m_Buffer     = VK_NULL_HANDLE;
+    char        *m_MappedData = nullptr;
+    VkDeviceSize m_Size       = 0;
+    VkDeviceSize m_Alignment  = 1;
+
+    VkDeviceSize m_Head         = 0;
+    VkDeviceSize m_PeakUsedSize = 0;
+};
+
+template <typename T>
+std::optional<uint32_t> UniformArena::Write(T const &Data)
+{
+    std::optional<UniformRegion> const Region = Allocate(sizeof(T));
+    if (!Region)
+    {
+        return std::nullopt;
+    }
+
+    *static_cast<T *>(Region->MappedData) = Data;
+    return Region->DynamicOffset;
+}
+
+#endif // !VULKANLEARNING_UNIFORMARENA
@@ -0,0 +1,327 @@
+#include "UploadBatch.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+void UploadBatch::Init(
+    VkDevice           Device,
+    VkQueue            Queue,
+    uint32_t           QueueFamilyIndex,
+    uint32_t           DestinationQueueFamilyIndex,
+    VkCommandPool      CommandPool,
+    TimelineSemaphore *Timeline,
+    StagingRing       *Ring
+)
+{
+    m_VkDevice                    = Device;
+    m_VkQueue                     = Queue;
+    m_QueueFamilyIndex            = QueueFamilyIndex;
+    m_DestinationQueueFamilyIndex = DestinationQueueFamilyIndex;
+    m_VkCommandPool               = CommandPool;
+    m_Timeline                    = Timeline;
+    m_StagingRing                 = Ring;
+}
+
+void UploadBatch::Shutdown()
+{
+    WaitIdle();
+    m_PendingOwnershipAcquires.clear();
+}
+
+void UploadBatch::UploadBuffer(
+    VkBuffer Destination, void const *Data, VkDeviceSize Size, VkDeviceSize DestinationOffset
+)
+{
+    char const  *Source   = static_cast<char const *>(Data);
+    VkDeviceSize Uploaded = 0;
+    while (Uploaded < Size)
+    {
+        // Anything bigger than the ring streams through it in chunks
+        VkDeviceSize const  ChunkSize = std::min(Size - Uploaded, m_StagingRing->GetSize());
+        StagingRegion const Region    = AcquireStagingRegion(ChunkSize);
+
+        std::memcpy(Region.MappedData, Source + Uploaded, static_cast<size_t>(ChunkSize));
+
+        BeginRecording();
+
+        VkBufferCopy CopyInfo{};
+        CopyInfo.srcOffset = Region.Offset;
+        CopyInfo.dstOffset = DestinationOffset + Uploaded;
+        CopyInfo.size      = ChunkSize;
+        vkCmdCopyBuffer(m_VkRecordingCommandBuffer, Region.Buffer, Destination, 1, &CopyInfo);
+
+        if (std::find(m_RecordedDestinations.begin(), m_RecordedDestinations.end(), Destination) ==
+            m_RecordedDestinations.end())
+        {
+            m_RecordedDestinations.push_back(Destination);
+        }
+
+        ++m_NumRecordedCopies;
+        Uploaded += ChunkSize;
+    }
+}
+
+uint64_t UploadBatch::Submit()
+{
+    if (m_VkRecordingCommandBuffer == VK_NULL_HANDLE)
+    {
+        return m_Timeline->GetLastSubmittedValue();
+    }
+
+    RecordReleaseBarriers();
+
+    vkEndCommandBuffer(m_VkRecordingCommandBuffer);
+
+    Submission NewSubmission{};
+    NewSubmission.CommandBuffer = m_VkRecordingCommandBuffer;
+    NewSubmission.Value         = m_Timeline->ReserveNextValue();
+
+    VkSemaphore const TimelineSemaphoreHandle = m_Timeline->Get();
+
+    VkTimelineSemaphoreSubmitInfo TimelineSubmitInfo{};
+    TimelineSubmitInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    TimelineSubmitInfo.signalSemaphoreValueCount = 1;
+    TimelineSubmitInfo.pSignalSemaphoreValues    = &NewSubmission.Value;
+
+    VkSubmitInfo SubmitInfo{};
+    SubmitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    SubmitInfo.pNext                = &TimelineSubmitInfo;
+    SubmitInfo.commandBufferCount   = 1;
+    SubmitInfo.pCommandBuffers      = &NewSubmission.CommandBuffer;
+    SubmitInfo.signalSemaphoreCount = 1;
+    SubmitInfo.pSignalSemaphores    = &TimelineSemaphoreHandle;
+
+    if (vkQueueSubmit(m_VkQueue, 1, &SubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to submit upload batch!");
+        exit(1);
+    }
+
+    // Staging space used by this batch comes back once it is completed
+    m_StagingRing->Retire(NewSubmission.Value);
+    m_InFlightSubmissions.push_back(NewSubmission);
+
+    // Graphics queue waits for this value before acquiring the buffers
+    if (IsOwnershipTransferRequired())
+    {
+        QueueOwnershipAcquire OwnershipAcquire{};
+        OwnershipAcquire.Buffers     = m_RecordedDestinations;
+        OwnershipAcquire.UploadValue = NewSubmission.Value;
+        m_PendingOwnershipAcquires.push_back(std::move(OwnershipAcquire));
+    }
+
+    ++m_NumSubmissions;
+    m_VkRecordingCommandBuffer = VK_NULL_HANDLE;
+    m_NumRecordedCopies        = 0;
+    m_RecordedDestinations.clear();
+
+    return NewSubmission.Value;
+}
+
+bool UploadBatch::IsComplete(uint64_t Value)
+{
+    bool const bComplete = m_Timeline->IsComplete(Value);
+    RetireSubmissions();
+    return bComplete;
+}
+
+void UploadBatch::Wait(uint64_t Value)
+{
+    // Unsubmitted value would never complete
+    m_Timeline->Wait(std::min(Value, m_Timeline->GetLastSubmittedValue()));
+    RetireSubmissions();
+}
+
+void UploadBatch::WaitIdle()
+{
+    Wait(Submit());
+}
+
+void UploadBatch::RecordReleaseBarriers()
+{
+    if (!IsOwnershipTransferRequired())
+    {
+        // Same queue - copied data can be read as vertices and indices by anything submitted later
+        VkMemoryBarrier UploadBarrier{};
+        UploadBarrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        UploadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        UploadBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+        vkCmdPipelineBarrier(
+            m_VkRecordingCommandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            0,
+            1,
+            &UploadBarrier,
+            0,
+            nullptr,
+            0,
+            nullptr
+        );
+        return;
+    }
+
+    std::vector<VkBufferMemoryBarrier> ReleaseBarriers;
+    for (VkBuffer Buffer : m_RecordedDestinations)
+    {
+        VkBufferMemoryBarrier ReleaseBarrier{};
+        ReleaseBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        ReleaseBarrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+        ReleaseBarrier.dstAccessMask       = 0; // Ignored for release
+        ReleaseBarrier.srcQueueFamilyIndex = m_QueueFamilyIndex;
+        ReleaseBarrier.dstQueueFamilyIndex = m_DestinationQueueFamilyIndex;
+        ReleaseBarrier.buffer              = Buffer;
+        ReleaseBarrier.offset              = 0;
+        ReleaseBarrier.size                = VK_WHOLE_SIZE;
+        ReleaseBarriers.push_back(ReleaseBarrier);
+    }
+
+    // Transfer-only queue doesn't know vertex input stage, graphics side makes data visible on acquire
+    vkCmdPipelineBarrier(
+        m_VkRecordingCommandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0,
+        nullptr,
+        static_cast<uint32_t>(ReleaseBarriers.size()),
+        ReleaseBarriers.data(),
+        0,
+        nullptr
+    );
+}
+
+void UploadBatch::BeginRecording()
+{
+    if (m_VkRecordingCommandBuffer != VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+    CommandBufferAllocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    CommandBufferAllocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    CommandBufferAllocateInfo.commandPool        = m_VkCommandPool;
+    CommandBufferAllocateInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(m_VkDevice, &CommandBufferAllocateInfo, &m_VkRecordingCommandBuffer) !=
+        VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to create upload command buffer!");
+        exit(1);
+    }
+
+    VkCommandBufferBeginInfo BeginInfo{};
+    BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(m_VkRecordingCommandBuffer, &BeginInfo);
+}
+
+std::vector<QueueOwnershipAcquire> UploadBatch::TakeOwnershipAcquires()
+{
+    std::vector<QueueOwnershipAcquire> OwnershipAcquires;
+    for (QueueOwnershipAcquire &OwnershipAcquire : m_PendingOwnershipAcquires)
+    {
+        // All buffers are gone, nothing to wait for
+        if (!OwnershipAcquire.Buffers.empty())
+        {
+            OwnershipAcquires.push_back(std::move(OwnershipAcquire));
+        }
+    }
+    m_PendingOwnershipAcquires.clear();
+    return OwnershipAcquires;
+}
+
+void UploadBatch::RecordAcquireBarriers(
+    VkCommandBuffer CommandBuffer, std::vector<QueueOwnershipAcquire> const &OwnershipAcquires
+) const
+{
+    VkAccessFlags const DestinationAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+
+    std::vector<VkBufferMemoryBarrier> AcquireBarriers;
+    for (QueueOwnershipAcquire const &OwnershipAcquire : OwnershipAcquires)
+    {
+        for (VkBuffer Buffer : OwnershipAcquire.Buffers)
+        {
+            // Has to match release barrier, except access masks
+            VkBufferMemoryBarrier AcquireBarrier{};
+            AcquireBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            AcquireBarrier.srcAccessMask       = 0;
+            AcquireBarrier.dstAccessMask       = DestinationAccess;
+            AcquireBarrier.srcQueueFamilyIndex = m_QueueFamilyIndex;
+            AcquireBarrier.dstQueueFamilyIndex = m_DestinationQueueFamilyIndex;
+            AcquireBarrier.buffer              = Buffer;
+            AcquireBarrier.offset              = 0;
+            AcquireBarrier.size                = VK_WHOLE_SIZE;
+            AcquireBarriers.push_back(AcquireBarrier);
+        }
+    }
+
+    if (AcquireBarriers.empty())
+    {
+        return;
+    }
+
+    // Source stage chains with semaphore wait stage of the frame submission
+    vkCmdPipelineBarrier(
+        CommandBuffer,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+        0,
+        0,
+        nullptr,
+        static_cast<uint32_t>(AcquireBarriers.size()),
+        AcquireBarriers.data(),
+        0,
+        nullptr
+    );
+}
+
+void UploadBatch::ForgetBuffer(VkBuffer Buffer)
+{
+    for (QueueOwnershipAcquire &OwnershipAcquire : m_PendingOwnershipAcquires)
+    {
+        std::vector<VkBuffer> &Buffers = OwnershipAcquire.Buffers;
+        Buffers.erase(std::remove(Buffers.begin(), Buffers.end(), Buffer), Buffers.end());
+    }
+}
+
+StagingRegion UploadBatch::AcquireStagingRegion(VkDeviceSize Size)
+{
+    RetireSubmissions();
+
+    std::optional<StagingRegion> Region = m_StagingRing->Allocate(Size);
+    while (!Region.has_value())
+    {
+        if (std::optional<uint64_t> const OldestValue = m_StagingRing->GetOldestPendingValue())
+        {
+            Wait(OldestValue.value());
+        }
+        else if (m_VkRecordingCommandBuffer != VK_NULL_HANDLE)
+        {
+            Submit(); // Ring is full of this batch only - flush it and wait on the next iteration
+        }
+        else
+        {
+            VKL_CRITICAL("Staging ring can't fit {} bytes!", Size);
+            exit(1);
+        }
+        Region = m_StagingRing->Allocate(Size);
+    }
+    return Region.value();
+}
+
+void UploadBatch::RetireSubmissions()
+{
+    uint64_t const CompletedValue = m_Timeline->GetCompletedValue();
+    while (!m_InFlightSubmissions.empty() && m_InFlightSubmissions.front().Value <= CompletedValue)
+    {
+        vkFreeCommandBuffers(m_VkDevice, m_VkCommandPool, 1, &m_InFlightSubmissions.front().CommandBuffer);
+        m_InFlightSubmissions.pop_front();
+    }
+
+    m_StagingRing->Reclaim(CompletedValue);
+}
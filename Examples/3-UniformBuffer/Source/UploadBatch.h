@@ -0,0 +1,97 @@
+#ifndef VULKANLEARNING_UPLOADBATCH
+#define VULKANLEARNING_UPLOADBATCH
+
+#include "StagingRing.h"
+#include "TimelineSemaphore.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// Buffers released by transfer queue family, graphics queue has to acquire them after transfer timeline
+// reaches UploadValue
+struct QueueOwnershipAcquire
+{
+    std::vector<VkBuffer> Buffers;
+    uint64_t              UploadValue = 0;
+};
+
+// Records any number of copies from staging ring into one command buffer and submits them at once.
+// Every submission signals next value of queue timeline, callers poll or wait on it instead of the queue
+class UploadBatch
+{
+public:
+    // With different queue families uploaded buffers are released to DestinationQueueFamilyIndex
+    void Init(
+        VkDevice           Device,
+        VkQueue            Queue,
+        uint32_t           QueueFamilyIndex,
+        uint32_t           DestinationQueueFamilyIndex,
+        VkCommandPool      CommandPool,
+        TimelineSemaphore *Timeline,
+        StagingRing       *Ring
+    );
+    void Shutdown();
+
+    // Data is copied to staging memory immediately, GPU copy happens after Submit
+    void UploadBuffer(
+        VkBuffer Destination, void const *Data, VkDeviceSize Size, VkDeviceSize DestinationOffset = 0
+    );
+
+    // Returns timeline value of this submission, or of the last one if nothing was recorded
+    uint64_t Submit();
+
+    bool IsComplete(uint64_t Value);
+    void Wait(uint64_t Value);
+    void WaitIdle(); // Submits recorded copies as well
+
+    // Submitted uploads graphics queue hasn't acquired yet, empty if queue families are the same
+    std::vector<QueueOwnershipAcquire> TakeOwnershipAcquires();
+    void RecordAcquireBarriers(
+        VkCommandBuffer CommandBuffer, std::vector<QueueOwnershipAcquire> const &OwnershipAcquires
+    ) const;
+
+    // Buffer destroyed before it was acquired
+    void ForgetBuffer(VkBuffer Buffer);
+
+    bool IsOwnershipTransferRequired() const { return m_QueueFamilyIndex != m_DestinationQueueFamilyIndex; }
+
+    uint32_t GetNumRecordedCopies() const { return m_NumRecordedCopies; }
+    uint64_t GetNumSubmissions() const { return m_NumSubmissions; }
+
+private:
+    struct Submission
+    {
+        VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+        uint64_t        Value         = 0;
+    };
+
+    void          BeginRecording();
+    void          RecordReleaseBarriers();
+    StagingRegion AcquireStagingRegion(VkDeviceSize Size);
+
+    // Releases everything that belongs to finished submissions, in submission order
+    void RetireSubmissions();
+
+private:
+    VkDevice           m_VkDevice      = VK_NULL_HANDLE;
+    VkQueue            m_VkQueue       = VK_NULL_HANDLE;
+    VkCommandPool      m_VkCommandPool = VK_NULL_HANDLE;
+    TimelineSemaphore *m_Timeline      = nullptr;
+    StagingRing       *m_StagingRing   = nullptr;
+
+    uint32_t m_QueueFamilyIndex            = 0;
+    uint32_t m_DestinationQueueFamilyIndex = 0;
+
+    VkCommandBuffer       m_VkRecordingCommandBuffer = VK_NULL_HANDLE;
+    uint32_t              m_NumRecordedCopies        = 0;
+    std::vector<VkBuffer> m_RecordedDestinations;
+
+    std::deque<Submission>             m_InFlightSubmissions;
+    std::vector<QueueOwnershipAcquire> m_PendingOwnershipAcquires;
+
+    uint64_t m_NumSubmissions = 0;
+};
+
+#endif // !VULKANLEARNING_UPLOADBATCH
@@ -1,10 +1,14 @@
 #include "VulkanApp.h"
 
 #include "MatricesUBO.h"
+#include "ObjectsUBO.h"
 #include "Utils.h"
 #include "glm/gtc/matrix_transform.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <random>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -16,13 +20,28 @@ constexpr bool g_bValidationLayersEnabled = true;
 constexpr bool g_bValidationLayersEnabled = false;
 #endif
 
-VulkanApp::VulkanApp(int const WindowWidth, int const WindowHeight)
-    : m_Window(WindowWidth, WindowHeight, "3-UniformBuffer")
+VulkanApp::VulkanApp(int const WindowWidth, int const WindowHeight, AppSettings const &Settings)
+    : m_Settings(Settings),
+      m_RequestedExtent{static_cast<uint32_t>(WindowWidth), static_cast<uint32_t>(WindowHeight)},
+      m_NumFramesInFlight(Settings.NumFramesInFlight)
 {
-    glfwSetWindowUserPointer(m_Window.Get(), this);
-    glfwSetFramebufferSizeCallback(m_Window.Get(), OnWindowResized);
+    m_PresentPolicy = Settings.Present;
 
-    VKL_INFO("VulkanApp created");
+    if (!m_Settings.bHeadless)
+    {
+        m_Window = std::make_unique<Window>(WindowWidth, WindowHeight, s_ApplicationName);
+        glfwSetWindowUserPointer(m_Window->Get(), this);
+        glfwSetFramebufferSizeCallback(m_Window->Get(), OnWindowResized);
+
+        auto const [Width, Height] = m_Window->GetFramebufferSize();
+        m_ResizeController.Init(Width, Height, static_cast<double>(m_Settings.ResizeIntervalMs));
+    }
+
+    VKL_INFO(
+        "VulkanApp created{}, {} frames in flight",
+        m_Settings.bHeadless ? " headless" : "",
+        m_NumFramesInFlight
+    );
 }
 
 void VulkanApp::Run()
@@ -36,31 +55,62 @@ void VulkanApp::InitVulkan()
 {
     VKL_INFO("Initializing Vulkan...");
 
-    if (!glfwVulkanSupported())
+    if (!m_Settings.bHeadless && !glfwVulkanSupported())
     {
         VKL_CRITICAL("Vulkan not supported!");
         exit(1);
     }
 
+    if (m_Settings.bTrackHostAllocations)
+    {
+        m_HostAllocationTracker = std::make_unique<HostAllocationTracker>();
+        m_pVkAllocator          = m_HostAllocationTracker->GetCallbacks();
+    }
+
     CreateVkInstance();
 
     CreateDebugCallback();
 
-    CreateSurface();
+    if (!m_Settings.bHeadless)
+    {
+        CreateSurface();
+    }
     SelectPhysicalDevice();
     CreateDevice();
     RetrieveQueuesFromDevice();
 
-    CreateSwapchain();
-    RetrieveSwapchainImages();
+    CreateDeviceMemoryAllocator();
+    CreateTimelineSemaphores();
+
+    if (m_Settings.bHeadless)
+    {
+        CreateOffscreenImages();
+    }
+    else
+    {
+        CreateSwapchain();
+        RetrieveSwapchainImages();
+    }
     CreateSwapchainImagesViews();
 
     CreateCommandPool();
-    AllocateCommandBuffers();
+    CreateRecordingWorkers();
+    CreateFrameContexts();
+    CreateCommandBufferCache();
+
+    CreateUploadBatch();
 
-    CreateVertexBuffer();
-    CreateIndexBuffer();
-    CreateUniformBuffers();
+    CreateGeometryBuffer();
+    CreateCubeMesh();
+    CreateInstanceBuffer();
+    m_UploadBatch.WaitIdle(); // Vertices, indices and instances go with one submission
+
+    if (m_Settings.bBenchmarkUploads)
+    {
+        RunUploadBenchmark();
+    }
+    CreateUniformArenas();
+    CreateIndirectDrawBuffers();
 
     CreateDescriptorSetLayout();
     CreateDescriptorPool();
@@ -68,12 +118,31 @@ void VulkanApp::InitVulkan()
 
     CreateRenderPass();
     CreatePipelineLayout();
+    CreatePipelineCache();
+
+    auto const PipelinesStartTime = std::chrono::high_resolution_clock::now();
     CreatePipeline();
+    std::chrono::duration<double, std::milli> const PipelinesCreationTime =
+        std::chrono::high_resolution_clock::now() - PipelinesStartTime;
+    VKL_INFO(
+        "Pipelines created in {:.3f} ms, {}",
+        PipelinesCreationTime.count(),
+        m_PipelineCache.IsWarm() ? "warm start" : "cold start"
+    );
 
     CreateFramebuffers();
 
     CreateSyncObjects();
 
+    if (m_Settings.bBenchmarkRecording)
+    {
+        RunRecordingBenchmark();
+    }
+    if (m_Settings.bBenchmarkSorting)
+    {
+        RunSortingBenchmark();
+    }
+
     VKL_INFO("Vulkan initialized");
 }
 
@@ -81,173 +150,373 @@ void VulkanApp::AppLoop()
 {
     VKL_INFO("VulkanApp running");
 
-    auto const [Width, Height] = m_Window.GetFramebufferSize();
-    m_Camera.Setup(glm::vec2{static_cast<float>(Width), static_cast<float>(Height)});
+    m_Camera.Setup(
+        glm::vec2{static_cast<float>(m_SwapchainExtent.width), static_cast<float>(m_SwapchainExtent.height)}
+    );
     m_Camera.SetPosition(glm::vec3{0.0f, 0.0f, 2.0f});
 
-    auto TimePoint1 = std::chrono::high_resolution_clock::now();
-    while (!glfwWindowShouldClose(m_Window.Get()))
+    // Driver host allocations made by frame loop only, init and shutdown excluded
+    uint64_t const NumHostAllocationsBefore =
+        m_HostAllocationTracker ? m_HostAllocationTracker->GetNumAllocations() : 0;
+    uint64_t NumFrames = 0;
+
+    auto const LoopStartTime = std::chrono::high_resolution_clock::now();
+    auto       TimePoint1    = LoopStartTime;
+    while (m_Settings.bHeadless ? NumFrames < m_Settings.NumHeadlessFrames
+                                : !glfwWindowShouldClose(m_Window->Get()))
     {
+        if (!m_Settings.bHeadless && m_ResizeController.IsMinimized())
+        {
+            // Nothing to render into - skip frames, but keep handling events instead of spinning
+            glfwWaitEventsTimeout(s_MinimizedWaitTimeout);
+            TimePoint1 = std::chrono::high_resolution_clock::now();
+            continue;
+        }
+
         auto const  TimePoint2 = std::chrono::high_resolution_clock::now();
         float const ElapsedTime =
             std::chrono::duration_cast<std::chrono::duration<float>>(TimePoint2 - TimePoint1).count();
 
-        UpdateCamera(ElapsedTime);
-        UpdateUniformBuffers();
+        m_LatencyTracker.OnInputSampled(); // Events were polled at the end of previous iteration
+        if (m_Settings.bHeadless)
+        {
+            UpdateSceneObjects(s_HeadlessFrameTime);
+        }
+        else
+        {
+            UpdateCamera(ElapsedTime);
+            ProcessRuntimeControls();
+            UpdateSceneObjects(ElapsedTime);
+        }
 
         DrawFrame();
-        glfwPollEvents();
+        if (!m_Settings.bHeadless)
+        {
+            glfwPollEvents();
+        }
 
         TimePoint1 = TimePoint2;
+        ++NumFrames;
     }
 
     vkDeviceWaitIdle(m_VkDevice);
+
+    std::chrono::duration<double> const LoopTime = std::chrono::high_resolution_clock::now() - LoopStartTime;
+    m_LatencyTracker.OnCompleted(m_GraphicsTimeline.GetCompletedValue());
+
+    if (NumFrames > 0)
+    {
+        VKL_INFO(
+            "{} frames in flight: {:.1f} frames per second, input to GPU done latency {:.2f} ms average, "
+            "{:.2f} ms max",
+            m_NumFramesInFlight,
+            static_cast<double>(NumFrames) / LoopTime.count(),
+            m_LatencyTracker.GetAverageLatencyMs(),
+            m_LatencyTracker.GetMaxLatencyMs()
+        );
+        VKL_INFO(
+            "Command buffers {}: {:.4f} ms of CPU time per frame",
+            m_Settings.bCacheCommandBuffers ? "cached" : "recorded every frame",
+            m_CommandRecordingTimeMs / static_cast<double>(NumFrames)
+        );
+        VKL_INFO(
+            "State commands per frame: {:.1f} issued, {:.1f} elided, {:.1f} draws",
+            static_cast<double>(m_CommandRecorderStats.NumIssued) / static_cast<double>(NumFrames),
+            static_cast<double>(m_CommandRecorderStats.NumElided) / static_cast<double>(NumFrames),
+            static_cast<double>(m_CommandRecorderStats.NumDraws) / static_cast<double>(NumFrames)
+        );
+    }
+
+    if (m_ResizeController.GetNumEvents() > 0)
+    {
+        VKL_INFO(
+            "Resize: {} window events coalesced into {} swapchain rebuilds",
+            m_ResizeController.GetNumEvents(),
+            m_ResizeController.GetNumRebuilds()
+        );
+    }
+
+    if (m_HostAllocationTracker && NumFrames > 0)
+    {
+        uint64_t const NumHostAllocations =
+            m_HostAllocationTracker->GetNumAllocations() - NumHostAllocationsBefore;
+        VKL_INFO(
+            "Host allocations in frame loop: {} over {} frames, {:.2f} per frame",
+            NumHostAllocations,
+            NumFrames,
+            static_cast<double>(NumHostAllocations) / static_cast<double>(NumFrames)
+        );
+    }
 }
 
 void VulkanApp::CleanUp()
 {
     VKL_INFO("VulkanApp is stopping...");
 
+    m_DeletionQueue.FlushAll(); // Device is idle
+
     DestroySyncObjects();
 
     DestroyFramebuffers();
 
     DestroyPipeline();
+    DestroyPipelineCache();
     DestroyPipelineLayout();
     DestroyRenderPass();
 
     DestroyDescriptorPool();
     DestroyDescriptorSetLayout();
 
-    DestroyUniformBuffers();
-    DestroyIndexBuffer();
-    DestroyVertexBuffer();
+    DestroyIndirectDrawBuffers();
+    DestroyUniformArenas();
+    DestroyInstanceBuffer();
+    DestroyGeometryBuffer();
 
+    DestroyUploadBatch();
+
+    DestroyCommandBufferCache();
+    DestroyFrameContexts();
+    DestroyRecordingWorkers();
     DestroyCommandPool();
 
     DestroySwapchainImagesViews();
-    DestroySwapchain();
+    if (m_Settings.bHeadless)
+    {
+        DestroyOffscreenImages(); // Memory comes from allocator
+    }
+    else
+    {
+        DestroySwapchain();
+    }
+
+    DestroyTimelineSemaphores();
+    DestroyDeviceMemoryAllocator();
 
     DestroyDevice();
-    DestroySurface();
+    if (!m_Settings.bHeadless)
+    {
+        DestroySurface();
+    }
 
     DestroyDebugCallback();
 
     DestroyVkInstance();
 
+    if (m_HostAllocationTracker)
+    {
+        m_HostAllocationTracker->LogStats();
+    }
+
     VKL_INFO("VulkanApp resources cleaned up");
 }
 
 void VulkanApp::UpdateCamera(float ElapsedTime)
 {
-    if (glfwGetKey(m_Window.Get(), GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    if (glfwGetKey(m_Window->Get(), GLFW_KEY_ESCAPE) == GLFW_PRESS)
     {
-        glfwSetWindowShouldClose(m_Window.Get(), GLFW_TRUE);
+        glfwSetWindowShouldClose(m_Window->Get(), GLFW_TRUE);
     }
 
-    if (glfwGetKey(m_Window.Get(), GLFW_KEY_W) == GLFW_PRESS)
+    glm::vec3 const OldPosition = m_Camera.GetPosition();
+    glm::vec3 const OldForward  = m_Camera.GetForward();
+
+    if (glfwGetKey(m_Window->Get(), GLFW_KEY_W) == GLFW_PRESS)
     {
         m_Camera.ProcessMovement(CameraMoveDirection::Forward, 1.0f, ElapsedTime);
     }
-    if (glfwGetKey(m_Window.Get(), GLFW_KEY_A) == GLFW_PRESS)
+    if (glfwGetKey(m_Window->Get(), GLFW_KEY_A) == GLFW_PRESS)
     {
         m_Camera.ProcessMovement(CameraMoveDirection::Left, 1.0f, ElapsedTime);
     }
-    if (glfwGetKey(m_Window.Get(), GLFW_KEY_S) == GLFW_PRESS)
+    if (glfwGetKey(m_Window->Get(), GLFW_KEY_S) == GLFW_PRESS)
     {
         m_Camera.ProcessMovement(CameraMoveDirection::Backward, 1.0f, ElapsedTime);
     }
-    if (glfwGetKey(m_Window.Get(), GLFW_KEY_D) == GLFW_PRESS)
+    if (glfwGetKey(m_Window->Get(), GLFW_KEY_D) == GLFW_PRESS)
     {
         m_Camera.ProcessMovement(CameraMoveDirection::Right, 1.0f, ElapsedTime);
     }
 
-    if (glfwGetKey(m_Window.Get(), GLFW_KEY_SPACE) == GLFW_PRESS)
+    if (glfwGetKey(m_Window->Get(), GLFW_KEY_SPACE) == GLFW_PRESS)
     {
         m_Camera.ProcessMovement(CameraMoveDirection::Up, 1.0f, ElapsedTime);
     }
-    if (glfwGetKey(m_Window.Get(), GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if (glfwGetKey(m_Window->Get(), GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
     {
         m_Camera.ProcessMovement(CameraMoveDirection::Down, 1.0f, ElapsedTime);
     }
 
     double dXPos, dYPos;
-    glfwGetCursorPos(m_Window.Get(), &dXPos, &dYPos);
+    glfwGetCursorPos(m_Window->Get(), &dXPos, &dYPos);
 
     glm::vec2 NewPos      = glm::vec2{static_cast<float>(dXPos), static_cast<float>(dYPos)};
     glm::vec2 CursorDelta = NewPos - m_CursorPos;
     CursorDelta.y *= -1;
     m_Camera.ProcessRotation(CursorDelta, 100.0f, ElapsedTime);
     m_CursorPos = NewPos;
+
+    // Depths of objects are relative to camera
+    if (m_Camera.GetPosition() != OldPosition || m_Camera.GetForward() != OldForward)
+    {
+        m_bSceneDirty = true;
+    }
+}
+
+void VulkanApp::ProcessRuntimeControls()
+{
+    if (IsKeyPressedOnce(GLFW_KEY_R))
+    {
+        RecreatePipeline();
+    }
+    if (IsKeyPressedOnce(GLFW_KEY_P))
+    {
+        uint32_t const NextPolicy = (static_cast<uint32_t>(m_PresentPolicy) + 1) %
+                                    static_cast<uint32_t>(PresentPolicy::Count);
+        m_PresentPolicy = static_cast<PresentPolicy>(NextPolicy);
+        RecreateSwapchain();
+    }
+}
+
+bool VulkanApp::IsKeyPressedOnce(int Key)
+{
+    if (glfwGetKey(m_Window->Get(), Key) != GLFW_PRESS)
+    {
+        m_HeldKeys.erase(Key);
+        return false;
+    }
+    return m_HeldKeys.insert(Key).second;
 }
 
 void VulkanApp::DrawFrame()
 {
     /*
     1) Wait for the previous frame to finish
-    2) Acquire an image from the swap chain
+    2) Acquire an image from the swap chain(headless - take offscreen image of the frame)
     3) Record a command buffer which draws the scene onto that image
     4) Submit the recorded command buffer
-    5) Present the swap chain image
+    5) Present the swap chain image(not in headless mode)
     */
 
+    FrameContext &Frame = m_FrameContexts[m_CurrentFrame];
+
     // 1
-    vkWaitForFences(m_VkDevice, 1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+    m_GraphicsTimeline.Wait(Frame.GetTimelineValue());
+    m_LatencyTracker.OnCompleted(m_GraphicsTimeline.GetCompletedValue());
+    m_DeletionQueue.Flush(m_GraphicsTimeline.GetCompletedValue());
+    Frame.Reset(); // All command buffers of the frame at once
+    m_MemoryBudgetTracker.Update();
+    UpdateUniformBuffers();
 
     // 2
-    uint32_t SwapchainImageIndex = 0;
-    VkResult AcquisitionResult   = vkAcquireNextImageKHR(
-        m_VkDevice,
-        m_VkSwapchain,
-        UINT64_MAX,
-        m_ImageAvailableSemaphores[m_CurrentFrame],
-        VK_NULL_HANDLE,
-        &SwapchainImageIndex
-    );
-    if (AcquisitionResult == VK_ERROR_OUT_OF_DATE_KHR) // swapchain not suitable now(after screen resize)
-    {
-        RecreateSwapchain();
-        return;
+    uint32_t SwapchainImageIndex = m_CurrentFrame; // Headless - image of this frame, free once frame finished
+    if (!m_Settings.bHeadless)
+    {
+        VkResult AcquisitionResult = vkAcquireNextImageKHR(
+            m_VkDevice,
+            m_VkSwapchain,
+            UINT64_MAX,
+            m_ImageAvailableSemaphores[m_CurrentFrame],
+            VK_NULL_HANDLE,
+            &SwapchainImageIndex
+        );
+        if (AcquisitionResult == VK_ERROR_OUT_OF_DATE_KHR) // swapchain not suitable now(after screen resize)
+        {
+            RecreateSwapchain();
+            return;
+        }
+        // SUBOPTIMAL - swapchain properties not matched exactly
+        else if (AcquisitionResult != VK_SUCCESS && AcquisitionResult != VK_SUBOPTIMAL_KHR)
+        {
+            VKL_CRITICAL("Failed to acquire swapchain image!");
+            exit(1);
+        }
     }
-    else if (AcquisitionResult != VK_SUCCESS && AcquisitionResult != VK_SUBOPTIMAL_KHR) // second - swapchain
-                                                                                        // properties not
-                                                                                        // matched exactly
+
+    // 3
+    auto const RecordingStartTime = std::chrono::high_resolution_clock::now();
+
+    VkCommandBuffer CommandBuffers[2] = {};
+    uint32_t        NumCommandBuffers = 0;
+
+    m_FramesOwnershipAcquires[m_CurrentFrame] = m_UploadBatch.TakeOwnershipAcquires();
+    if (!m_FramesOwnershipAcquires[m_CurrentFrame].empty())
     {
-        VKL_CRITICAL("Failed to acquire swapchain image!");
-        exit(1);
+        CommandBuffers[NumCommandBuffers++] = RecordOwnershipAcquires();
     }
 
-    // Reset fences here to avoid deadlock
-    vkResetFences(m_VkDevice, 1, &m_InFlightFences[m_CurrentFrame]);
+    if (m_Settings.bCacheCommandBuffers)
+    {
+        // Before Acquire - both may invalidate the cache
+        UpdateRenderQueue();
+        FillIndirectDraws(m_RenderQueue.GetPackets());
 
-    // 3
-    vkResetCommandBuffer(m_VkCommandBuffers[m_CurrentFrame], 0);
-    RecordCommandBuffer(m_VkCommandBuffers[m_CurrentFrame], SwapchainImageIndex);
+        bool                  bOutdated = false;
+        VkCommandBuffer const CommandBuffer =
+            m_CommandBufferCache.Acquire(SwapchainImageIndex, m_CurrentFrame, bOutdated);
+        if (bOutdated)
+        {
+            // Secondary buffers of workers live for one frame only, cached ones are recorded inline
+            RecordCommandBuffer(CommandBuffer, SwapchainImageIndex, m_RenderQueue.GetPackets(), 0);
+        }
+        CommandBuffers[NumCommandBuffers++] = CommandBuffer;
+    }
+    else
+    {
+        VkCommandBuffer const CommandBuffer = Frame.AcquireCommandBuffer(0, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        BuildRenderQueue();
+        FillIndirectDraws(m_RenderQueue.GetPackets());
+        RecordCommandBuffer(
+            CommandBuffer, SwapchainImageIndex, m_RenderQueue.GetPackets(), m_Settings.NumRecordingThreads
+        );
+        CommandBuffers[NumCommandBuffers++] = CommandBuffer;
+    }
+
+    std::chrono::duration<double, std::milli> const RecordingTime =
+        std::chrono::high_resolution_clock::now() - RecordingStartTime;
+    m_CommandRecordingTimeMs += RecordingTime.count();
 
     // 4
-    SubmitCommandBuffer(m_VkCommandBuffers[m_CurrentFrame]);
+    SubmitCommandBuffers(CommandBuffers, NumCommandBuffers);
+    m_LatencyTracker.OnSubmitted(m_GraphicsTimeline.GetLastSubmittedValue());
 
     // 5
-    VkResult QueuePresentResult = PresentResult(SwapchainImageIndex);
-    if (QueuePresentResult == VK_ERROR_OUT_OF_DATE_KHR || QueuePresentResult == VK_SUBOPTIMAL_KHR ||
-        m_bWindowResizeHappened)
+    if (!m_Settings.bHeadless)
     {
-        RecreateSwapchain();
-        m_bWindowResizeHappened = false;
-    }
-    else if (QueuePresentResult != VK_SUCCESS)
-    {
-        VKL_CRITICAL("Failed to present swapchain image!");
-        exit(1);
+        VkResult QueuePresentResult = PresentResult(SwapchainImageIndex);
+        if (QueuePresentResult == VK_ERROR_OUT_OF_DATE_KHR) // Can't be presented to anymore
+        {
+            RecreateSwapchain();
+        }
+        else if (QueuePresentResult == VK_SUBOPTIMAL_KHR) // Still usable, scaled by presentation engine
+        {
+            m_ResizeController.RequestRebuild();
+        }
+        else if (QueuePresentResult != VK_SUCCESS)
+        {
+            VKL_CRITICAL("Failed to present swapchain image!");
+            exit(1);
+        }
+
+        // Until then frames are rendered at the old extent
+        if (m_ResizeController.ShouldRebuild())
+        {
+            RecreateSwapchain();
+        }
     }
 
-    m_CurrentFrame = (m_CurrentFrame + 1) % s_FramesInFlight;
+    m_CurrentFrame = (m_CurrentFrame + 1) % m_NumFramesInFlight;
 }
 
 void VulkanApp::OnWindowResized(GLFWwindow *Window, int NewWidth, int NewHeight)
 {
-    VulkanApp *App               = static_cast<VulkanApp *>(glfwGetWindowUserPointer(Window));
-    App->m_bWindowResizeHappened = true;
+    VulkanApp *App = static_cast<VulkanApp *>(glfwGetWindowUserPointer(Window));
+    App->m_ResizeController.OnResized(NewWidth, NewHeight);
+
+    // Old extent image is stretched to the window until swapchain is rebuilt, aspect ratio follows window
+    if (!App->m_ResizeController.IsMinimized())
+    {
+        App->m_Camera.SetViewportSize(glm::vec2{static_cast<float>(NewWidth), static_cast<float>(NewHeight)});
+    }
 }
 
 void VulkanApp::CreateVkInstance()
@@ -257,7 +526,7 @@ void VulkanApp::CreateVkInstance()
     VkApplicationInfo ApplicationInfo{};
     ApplicationInfo.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO;
     ApplicationInfo.apiVersion         = VK_API_VERSION_1_3;
-    ApplicationInfo.pApplicationName   = m_Window.GetTitle();
+    ApplicationInfo.pApplicationName   = s_ApplicationName;
     ApplicationInfo.applicationVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
     ApplicationInfo.pEngineName        = "";
     ApplicationInfo.engineVersion      = VK_MAKE_API_VERSION(0, 1, 0, 0);
@@ -274,7 +543,7 @@ void VulkanApp::CreateVkInstance()
     InstanceCreateInfo.enabledLayerCount       = static_cast<uint32_t>(ValidationLayers.size());
     InstanceCreateInfo.ppEnabledLayerNames     = ValidationLayers.data();
 
-    if (vkCreateInstance(&InstanceCreateInfo, nullptr, &m_VkInstance) != VK_SUCCESS)
+    if (vkCreateInstance(&InstanceCreateInfo, m_pVkAllocator, &m_VkInstance) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkInstance!");
         exit(1);
@@ -284,14 +553,19 @@ void VulkanApp::CreateVkInstance()
 
 void VulkanApp::DestroyVkInstance()
 {
-    vkDestroyInstance(m_VkInstance, nullptr);
+    vkDestroyInstance(m_VkInstance, m_pVkAllocator);
     VKL_TRACE("VkInstance destroyed");
 }
 
 std::vector<char const *> VulkanApp::GetRequiredInstanceExtensions() const
 {
+    // Surface extensions are needed only to present to window
     uint32_t     NumRequiredExtensions = 0;
-    char const **RequiredExtensions    = glfwGetRequiredInstanceExtensions(&NumRequiredExtensions);
+    char const **RequiredExtensions    = nullptr;
+    if (!m_Settings.bHeadless)
+    {
+        RequiredExtensions = glfwGetRequiredInstanceExtensions(&NumRequiredExtensions);
+    }
 
     // clang-format off
     const std::vector<char const *> AdditionalExtensions
@@ -423,6 +697,9 @@ void VulkanApp::SelectPhysicalDevice()
 
     m_VkPhysicalDevice   = GetMostSuitablePhysicalDevice(PhysicalDevices);
     m_QueueFamilyIndices = GetPhysicalDeviceMostSuitableQueueFamilyIndices(m_VkPhysicalDevice);
+
+    // Memory types don't change for device - rank them once
+    m_MemoryPolicy.Build(m_VkPhysicalDevice);
 }
 
 std::vector<VkPhysicalDevice> VulkanApp::GetPhysicalDevices() const
@@ -456,6 +733,21 @@ VkPhysicalDeviceFeatures VulkanApp::GetPhysicalDeviceFeatures(VkPhysicalDevice P
     return PhysicalDeviceFeatures;
 }
 
+VkPhysicalDeviceVulkan12Features VulkanApp::GetPhysicalDeviceVulkan12Features(VkPhysicalDevice PhysicalDevice
+) const
+{
+    VkPhysicalDeviceVulkan12Features Vulkan12Features{};
+    Vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+
+    VkPhysicalDeviceFeatures2 Features{};
+    Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    Features.pNext = &Vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(PhysicalDevice, &Features);
+
+    Vulkan12Features.pNext = nullptr;
+    return Vulkan12Features;
+}
+
 std::vector<VkExtensionProperties> VulkanApp::GetPhysicalDeviceSupportedExtensions(
     VkPhysicalDevice PhysicalDevice
 ) const
@@ -507,35 +799,34 @@ bool VulkanApp::IsPhysicalDeviceSuitable(VkPhysicalDevice PhysicalDevice) const
     QueueFamilyIndices FamiliesIndices = GetPhysicalDeviceMostSuitableQueueFamilyIndices(PhysicalDevice);
     bool               bAllExtensionsSupported = IsPhysicalDeviceExtensionSupportComplete(PhysicalDevice);
 
-    bool bSwapchainSuitable = false;
-    if (bAllExtensionsSupported)
+    bool bSwapchainSuitable = m_Settings.bHeadless; // No swapchain at all
+    if (bAllExtensionsSupported && !m_Settings.bHeadless)
     {
         SwapchainSupportDetails SwapchainSupport = GetSwapchainSupportDetails(PhysicalDevice, m_VkSurface);
         bSwapchainSuitable =
             !SwapchainSupport.PresentationMode.empty() && !SwapchainSupport.SurfaceFormats.empty();
     }
 
-    return FamiliesIndices.IsComplete() && bAllExtensionsSupported && bSwapchainSuitable;
+    return FamiliesIndices.IsComplete(!m_Settings.bHeadless) && bAllExtensionsSupported &&
+           bSwapchainSuitable && IsPhysicalDeviceTimelineSemaphoreSupported(PhysicalDevice);
+}
+
+bool VulkanApp::IsPhysicalDeviceTimelineSemaphoreSupported(VkPhysicalDevice PhysicalDevice) const
+{
+    if (GetPhysicalDeviceProperties(PhysicalDevice).apiVersion < VK_API_VERSION_1_2)
+    {
+        return false;
+    }
+    return GetPhysicalDeviceVulkan12Features(PhysicalDevice).timelineSemaphore;
 }
 
 bool VulkanApp::IsPhysicalDeviceExtensionSupportComplete(VkPhysicalDevice PhysicalDevice) const
 {
-    std::vector<char const *>          RequiredExtensions = GetRequiredDeviceExtensions();
-    std::vector<VkExtensionProperties> SupportedExtensions =
-        GetPhysicalDeviceSupportedExtensions(PhysicalDevice);
+    std::vector<char const *> RequiredExtensions = GetRequiredDeviceExtensions();
 
     for (char const *RequiredExtension : RequiredExtensions)
     {
-        bool IsSupported = false;
-        for (VkExtensionProperties const &SupportedExtension : SupportedExtensions)
-        {
-            if (std::strcmp(RequiredExtension, SupportedExtension.extensionName) == 0)
-            {
-                IsSupported = true;
-                break;
-            }
-        }
-        if (!IsSupported)
+        if (!IsPhysicalDeviceExtensionSupported(PhysicalDevice, RequiredExtension))
         {
             return false;
         }
@@ -544,6 +835,23 @@ bool VulkanApp::IsPhysicalDeviceExtensionSupportComplete(VkPhysicalDevice Physic
     return true;
 }
 
+bool VulkanApp::IsPhysicalDeviceExtensionSupported(
+    VkPhysicalDevice PhysicalDevice, char const *Extension
+) const
+{
+    std::vector<VkExtensionProperties> SupportedExtensions =
+        GetPhysicalDeviceSupportedExtensions(PhysicalDevice);
+
+    for (VkExtensionProperties const &SupportedExtension : SupportedExtensions)
+    {
+        if (std::strcmp(Extension, SupportedExtension.extensionName) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 uint32_t VulkanApp::GetPhysicalDeviceSuitability(VkPhysicalDevice const PhysicalDevice) const
 {
     uint32_t Score = 0;
@@ -604,10 +912,16 @@ QueueFamilyIndices VulkanApp::GetPhysicalDeviceMostSuitableQueueFamilyIndices(Vk
     FamilyIndices.GraphicsFamily = GetPhysicalDeviceMostSuitableQueueFamily(
         PhysicalDevice, QueueFamiliesProperties, &VulkanApp::GetPhysicalDeviceGraphicsQueueFamilySuitability
     );
-    FamilyIndices.PresentationFamily = GetPhysicalDeviceMostSuitableQueueFamily(
-        PhysicalDevice,
-        QueueFamiliesProperties,
-        &VulkanApp::GetPhysicalDevicePresentationQueueFamilySuitability
+    if (!m_Settings.bHeadless)
+    {
+        FamilyIndices.PresentationFamily = GetPhysicalDeviceMostSuitableQueueFamily(
+            PhysicalDevice,
+            QueueFamiliesProperties,
+            &VulkanApp::GetPhysicalDevicePresentationQueueFamilySuitability
+        );
+    }
+    FamilyIndices.TransferFamily = GetPhysicalDeviceMostSuitableQueueFamily(
+        PhysicalDevice, QueueFamiliesProperties, &VulkanApp::GetPhysicalDeviceTransferQueueFamilySuitability
     );
     return FamilyIndices;
 }
@@ -666,9 +980,12 @@ uint32_t VulkanApp::GetPhysicalDeviceGraphicsQueueFamilySuitability(
     }
 
     VkBool32 bPresentationSupported = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(
-        PhysicalDevice, QueueFamilyIndex, m_VkSurface, &bPresentationSupported
-    );
+    if (m_VkSurface != VK_NULL_HANDLE) // No surface in headless mode
+    {
+        vkGetPhysicalDeviceSurfaceSupportKHR(
+            PhysicalDevice, QueueFamilyIndex, m_VkSurface, &bPresentationSupported
+        );
+    }
     if (bPresentationSupported)
     {
         Score += 100;
@@ -717,6 +1034,35 @@ uint32_t VulkanApp::GetPhysicalDevicePresentationQueueFamilySuitability(
     return Score;
 }
 
+uint32_t VulkanApp::GetPhysicalDeviceTransferQueueFamilySuitability(
+    VkPhysicalDevice               PhysicalDevice,
+    VkQueueFamilyProperties const &QueueFamilyProperties,
+    uint32_t                       QueueFamilyIndex
+) const
+{
+    uint32_t           Score      = 0;
+    VkQueueFlags const QueueFlags = QueueFamilyProperties.queueFlags;
+
+    // Graphics and compute families support transfer even if the bit is not reported
+    if (!(QueueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+    {
+        return 0;
+    }
+
+    // Dedicated family is usually backed by DMA engine and runs alongside rendering
+    if (!(QueueFlags & VK_QUEUE_GRAPHICS_BIT))
+    {
+        Score += 100;
+    }
+    if (!(QueueFlags & VK_QUEUE_COMPUTE_BIT))
+    {
+        Score += 50;
+    }
+
+    Score += QueueFamilyProperties.queueCount;
+    return Score;
+}
+
 void VulkanApp::CreateDevice()
 {
     QueueFamilyIndices PhysicalDeviceQueueFamilyIndices =
@@ -725,9 +1071,13 @@ void VulkanApp::CreateDevice()
     // clang-format off
     std::unordered_set<uint32_t> QueueFamilyIndices{
         PhysicalDeviceQueueFamilyIndices.GraphicsFamily.value(),
-        PhysicalDeviceQueueFamilyIndices.PresentationFamily.value()
+        PhysicalDeviceQueueFamilyIndices.TransferFamily.value()
     };
     // clang-format on
+    if (PhysicalDeviceQueueFamilyIndices.PresentationFamily.has_value())
+    {
+        QueueFamilyIndices.insert(PhysicalDeviceQueueFamilyIndices.PresentationFamily.value());
+    }
 
     std::vector<VkDeviceQueueCreateInfo> QueueCreateInfos(QueueFamilyIndices.size());
 
@@ -747,11 +1097,44 @@ void VulkanApp::CreateDevice()
     // Features supported by VkPhysicalDevice that are requested for use by VkDevice
     VkPhysicalDeviceFeatures DeviceRequestedFeatures{};
 
+    VkPhysicalDeviceVulkan12Features DeviceRequestedVulkan12Features{};
+    DeviceRequestedVulkan12Features.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+    DeviceRequestedVulkan12Features.timelineSemaphore = VK_TRUE;
+
+    // Optional, without them every indirect command draws one mesh and draw count is known on CPU
+    if (m_Settings.bIndirectDraws)
+    {
+        m_bMultiDrawIndirectEnabled = GetPhysicalDeviceFeatures(m_VkPhysicalDevice).multiDrawIndirect;
+        m_bDrawIndirectCountEnabled = GetPhysicalDeviceVulkan12Features(m_VkPhysicalDevice).drawIndirectCount;
+        m_MaxDrawIndirectCount =
+            m_bMultiDrawIndirectEnabled
+                ? GetPhysicalDeviceProperties(m_VkPhysicalDevice).limits.maxDrawIndirectCount
+                : 1;
+
+        DeviceRequestedFeatures.multiDrawIndirect         = m_bMultiDrawIndirectEnabled;
+        DeviceRequestedVulkan12Features.drawIndirectCount = m_bDrawIndirectCountEnabled;
+
+        VKL_INFO(
+            "Indirect draws: multiDrawIndirect {}, drawIndirectCount {}",
+            m_bMultiDrawIndirectEnabled,
+            m_bDrawIndirectCountEnabled
+        );
+    }
+
     std::vector<char const *> Extensions       = GetRequiredDeviceExtensions();
     std::vector<char const *> ValidationLayers = GetRequiredDeviceValidationLayers();
 
+    // Optional, without it memory budget is estimated from heap sizes
+    m_bMemoryBudgetSupported =
+        IsPhysicalDeviceExtensionSupported(m_VkPhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (m_bMemoryBudgetSupported)
+    {
+        Extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
     VkDeviceCreateInfo DeviceCreateInfo{};
     DeviceCreateInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    DeviceCreateInfo.pNext                   = &DeviceRequestedVulkan12Features;
     DeviceCreateInfo.pQueueCreateInfos       = QueueCreateInfos.data();
     DeviceCreateInfo.queueCreateInfoCount    = static_cast<uint32_t>(QueueCreateInfos.size());
     DeviceCreateInfo.pEnabledFeatures        = &DeviceRequestedFeatures;
@@ -760,7 +1143,7 @@ void VulkanApp::CreateDevice()
     DeviceCreateInfo.enabledLayerCount       = static_cast<uint32_t>(ValidationLayers.size());
     DeviceCreateInfo.ppEnabledLayerNames     = ValidationLayers.data();
 
-    if (vkCreateDevice(m_VkPhysicalDevice, &DeviceCreateInfo, nullptr, &m_VkDevice) != VK_SUCCESS)
+    if (vkCreateDevice(m_VkPhysicalDevice, &DeviceCreateInfo, m_pVkAllocator, &m_VkDevice) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VKDevice!");
         exit(1);
@@ -770,12 +1153,17 @@ void VulkanApp::CreateDevice()
 
 void VulkanApp::DestroyDevice()
 {
-    vkDestroyDevice(m_VkDevice, nullptr);
+    vkDestroyDevice(m_VkDevice, m_pVkAllocator);
     VKL_TRACE("VkDevice destroyed");
 }
 
 std::vector<char const *> VulkanApp::GetRequiredDeviceExtensions() const
 {
+    if (m_Settings.bHeadless)
+    {
+        return {}; // Nothing is presented
+    }
+
     // clang-format off
     std::vector<char const *> DeviceExtensions
     {
@@ -794,9 +1182,20 @@ void VulkanApp::RetrieveQueuesFromDevice()
 {
     uint32_t QueueIndex = 0;
     vkGetDeviceQueue(m_VkDevice, m_QueueFamilyIndices.GraphicsFamily.value(), QueueIndex, &m_VkGraphicsQueue);
-    vkGetDeviceQueue(
-        m_VkDevice, m_QueueFamilyIndices.PresentationFamily.value(), QueueIndex, &m_VkPresentationQueue
-    );
+    if (m_QueueFamilyIndices.PresentationFamily.has_value())
+    {
+        vkGetDeviceQueue(
+            m_VkDevice, m_QueueFamilyIndices.PresentationFamily.value(), QueueIndex, &m_VkPresentationQueue
+        );
+    }
+    vkGetDeviceQueue(m_VkDevice, m_QueueFamilyIndices.TransferFamily.value(), QueueIndex, &m_VkTransferQueue);
+
+    if (m_QueueFamilyIndices.HasDedicatedTransferFamily())
+    {
+        VKL_INFO(
+            "Uploads use dedicated transfer queue family {}", m_QueueFamilyIndices.TransferFamily.value()
+        );
+    }
 
     VKL_TRACE("Retrieved VkQueues from VkDevice");
 }
@@ -825,8 +1224,9 @@ void VulkanApp::CreateDebugCallback()
         MessengerInfo.pUserData       = nullptr;
         // clang-format on
 
-        if (Utils::CreateDebugUtilsMessengerEXT(m_VkInstance, &MessengerInfo, nullptr, &m_VkDebugMessenger) !=
-            VK_SUCCESS)
+        if (Utils::CreateDebugUtilsMessengerEXT(
+                m_VkInstance, &MessengerInfo, m_pVkAllocator, &m_VkDebugMessenger
+            ) != VK_SUCCESS)
         {
             VKL_CRITICAL("Failed to create VkDebugUtilsMessengerEXT!");
             exit(1);
@@ -837,7 +1237,7 @@ void VulkanApp::CreateDebugCallback()
 
 void VulkanApp::DestroyDebugCallback()
 {
-    Utils::DestroyDebugUtilsMessengerEXT(m_VkInstance, m_VkDebugMessenger, nullptr);
+    Utils::DestroyDebugUtilsMessengerEXT(m_VkInstance, m_VkDebugMessenger, m_pVkAllocator);
     VKL_TRACE("DebugCallback destroyed");
 }
 
@@ -874,7 +1274,8 @@ VkBool32 VulkanApp::DebugCallback(
 
 void VulkanApp::CreateSurface()
 {
-    if (glfwCreateWindowSurface(m_VkInstance, m_Window.Get(), nullptr, &m_VkSurface) != VK_SUCCESS)
+    if (glfwCreateWindowSurface(m_VkInstance, m_Window->Get(), m_pVkAllocator, &m_VkSurface) !=
+        VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkSurface!");
         exit(1);
@@ -884,7 +1285,7 @@ void VulkanApp::CreateSurface()
 
 void VulkanApp::DestroySurface()
 {
-    vkDestroySurfaceKHR(m_VkInstance, m_VkSurface, nullptr);
+    vkDestroySurfaceKHR(m_VkInstance, m_VkSurface, m_pVkAllocator);
     VKL_TRACE("VkSurface destroyed");
 }
 
@@ -928,7 +1329,7 @@ VkExtent2D VulkanApp::SelectSwapchainExtent(VkSurfaceCapabilitiesKHR const &Capa
     }
     // else - surface size is determined by swapchain images size
 
-    std::pair<int, int> WindowBufferPixelsSize = m_Window.GetFramebufferSize();
+    std::pair<int, int> WindowBufferPixelsSize = m_Window->GetFramebufferSize();
 
     VkExtent2D Extent = {
         static_cast<uint32_t>(WindowBufferPixelsSize.first),
@@ -957,19 +1358,22 @@ VkSurfaceFormatKHR VulkanApp::SelectSwapchainSurfaceFormat(std::vector<VkSurface
 
 VkPresentModeKHR VulkanApp::SelectSwapchainPresentationMode(std::vector<VkPresentModeKHR> const &Modes) const
 {
-    for (VkPresentModeKHR const &Mode : Modes)
+    for (VkPresentModeKHR const PreferredMode : GetPreferredPresentModes(m_PresentPolicy))
     {
-        if (Mode == VK_PRESENT_MODE_MAILBOX_KHR)
+        if (std::find(Modes.begin(), Modes.end(), PreferredMode) != Modes.end())
         {
-            return Mode;
+            return PreferredMode;
         }
     }
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
-uint32_t VulkanApp::SelectSwapchainImagesCount(VkSurfaceCapabilitiesKHR const &Capabilities) const
+uint32_t VulkanApp::SelectSwapchainImagesCount(
+    VkSurfaceCapabilitiesKHR const &Capabilities, VkPresentModeKHR PresentMode
+) const
 {
-    uint32_t ImagesCount = Capabilities.minImageCount + 1;
+    uint32_t ImagesCount =
+        GetDesiredSwapchainImagesCount(m_PresentPolicy, PresentMode, Capabilities.minImageCount);
 
     if (Capabilities.maxImageCount != 0 && Capabilities.maxImageCount < ImagesCount)
     {                                             // maxImageCount == 0 -> count can be any value
@@ -979,14 +1383,14 @@ uint32_t VulkanApp::SelectSwapchainImagesCount(VkSurfaceCapabilitiesKHR const &C
     return ImagesCount;
 }
 
-void VulkanApp::CreateSwapchain()
+void VulkanApp::CreateSwapchain(VkSwapchainKHR OldSwapchain)
 {
     SwapchainSupportDetails SupportDetails = GetSwapchainSupportDetails(m_VkPhysicalDevice, m_VkSurface);
 
-    uint32_t const           ImagesCount = SelectSwapchainImagesCount(SupportDetails.SurfaceCapabilities);
     VkExtent2D const         Extent      = SelectSwapchainExtent(SupportDetails.SurfaceCapabilities);
     VkSurfaceFormatKHR const Format      = SelectSwapchainSurfaceFormat(SupportDetails.SurfaceFormats);
     VkPresentModeKHR const   PresentMode = SelectSwapchainPresentationMode(SupportDetails.PresentationMode);
+    uint32_t const ImagesCount = SelectSwapchainImagesCount(SupportDetails.SurfaceCapabilities, PresentMode);
 
     m_SwapchainExtent      = Extent;
     m_SwapchainImageFormat = Format.format;
@@ -1022,42 +1426,98 @@ void VulkanApp::CreateSwapchain()
     CreateInfo.preTransform   = SupportDetails.SurfaceCapabilities.currentTransform; // Don't want transforms
     CreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;                   // treat alpha as 1.0f
     CreateInfo.clipped        = VK_TRUE; // Ignore obstructed pixels
-    CreateInfo.oldSwapchain   = VK_NULL_HANDLE;
+    CreateInfo.oldSwapchain   = OldSwapchain;
 
-    if (vkCreateSwapchainKHR(m_VkDevice, &CreateInfo, nullptr, &m_VkSwapchain) != VK_SUCCESS)
+    if (vkCreateSwapchainKHR(m_VkDevice, &CreateInfo, m_pVkAllocator, &m_VkSwapchain) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkSwapchain!");
         exit(1);
     }
-    VKL_TRACE("Created VkSwapchain successfully");
+    VKL_INFO(
+        "Created VkSwapchain with {} present policy: {} mode, at least {} images",
+        PresentPolicyToString(m_PresentPolicy),
+        PresentModeToString(PresentMode),
+        ImagesCount
+    );
 }
 
 void VulkanApp::DestroySwapchain()
 {
-    vkDestroySwapchainKHR(m_VkDevice, m_VkSwapchain, nullptr);
+    vkDestroySwapchainKHR(m_VkDevice, m_VkSwapchain, m_pVkAllocator);
     VKL_TRACE("VkSwapchain destroyed");
 }
 
 void VulkanApp::RecreateSwapchain()
 {
-    // Handle minimized window event
-    std::pair<int, int> WindowFramebufferSize = m_Window.GetFramebufferSize();
-    while (WindowFramebufferSize.first == 0 || WindowFramebufferSize.second == 0)
+    // Swapchain can't have zero extent, rebuilt once window is restored
+    if (m_ResizeController.IsMinimized())
     {
-        WindowFramebufferSize = m_Window.GetFramebufferSize();
-        glfwWaitEvents();
+        m_ResizeController.RequestRebuild();
+        return;
     }
 
-    vkDeviceWaitIdle(m_VkDevice);
+    auto const StartTime = std::chrono::high_resolution_clock::now();
 
-    DestroyFramebuffers();
-    DestroySwapchainImagesViews();
-    DestroySwapchain();
+    if (m_Settings.bWaitIdleOnResize)
+    {
+        vkDeviceWaitIdle(m_VkDevice);
+    }
+
+    VkSwapchainKHR const OldSwapchain = m_VkSwapchain;
+    CreateSwapchain(OldSwapchain);
+    RetireSwapchain(OldSwapchain);
 
-    CreateSwapchain();
     RetrieveSwapchainImages();
     CreateSwapchainImagesViews();
     CreateFramebuffers();
+
+    // Extent, framebuffers and possibly number of images changed
+    if (m_Settings.bCacheCommandBuffers)
+    {
+        m_CommandBufferCache.Resize(static_cast<uint32_t>(m_SwapchainImages.size()), m_NumFramesInFlight);
+    }
+
+    m_Camera.SetViewportSize(
+        glm::vec2{static_cast<float>(m_SwapchainExtent.width), static_cast<float>(m_SwapchainExtent.height)}
+    );
+
+    std::chrono::duration<double, std::milli> const RecreationTime =
+        std::chrono::high_resolution_clock::now() - StartTime;
+    m_ResizeController.OnRebuilt(RecreationTime.count());
+    VKL_INFO(
+        "Swapchain recreated at {}x{} in {:.3f} ms{}",
+        m_SwapchainExtent.width,
+        m_SwapchainExtent.height,
+        RecreationTime.count(),
+        m_Settings.bWaitIdleOnResize ? ", device was drained" : ""
+    );
+}
+
+void VulkanApp::RetireSwapchain(VkSwapchainKHR OldSwapchain)
+{
+    // Presentation engine doesn't report when it's done with old images(only VK_EXT_swapchain_maintenance1
+    // does). Presents are queued right behind frames' commands, so they are done once those are
+    RetireResource(
+        [this,
+         OldSwapchain,
+         OldFramebuffers = std::move(m_VkFramebuffers),
+         OldImagesViews  = std::move(m_SwapchainImagesViews)]()
+        {
+            for (VkFramebuffer const Framebuffer : OldFramebuffers)
+            {
+                vkDestroyFramebuffer(m_VkDevice, Framebuffer, m_pVkAllocator);
+            }
+            for (VkImageView const ImageView : OldImagesViews)
+            {
+                vkDestroyImageView(m_VkDevice, ImageView, m_pVkAllocator);
+            }
+            vkDestroySwapchainKHR(m_VkDevice, OldSwapchain, m_pVkAllocator);
+        }
+    );
+
+    // Moved-from vectors are valid but unspecified
+    m_VkFramebuffers.clear();
+    m_SwapchainImagesViews.clear();
 }
 
 void VulkanApp::RetrieveSwapchainImages()
@@ -1071,19 +1531,86 @@ void VulkanApp::RetrieveSwapchainImages()
     VKL_TRACE("Retrieved VkImages from VkSwapchain");
 }
 
-void VulkanApp::CreateSwapchainImagesViews()
+void VulkanApp::CreateOffscreenImages()
 {
-    m_SwapchainImagesViews.resize(m_SwapchainImages.size());
-    for (size_t i = 0; i < m_SwapchainImages.size(); ++i)
+    m_SwapchainImageFormat = VK_FORMAT_B8G8R8A8_SRGB; // Same as preferred surface format
+    m_SwapchainExtent      = m_RequestedExtent;
+
+    m_SwapchainImages.resize(m_NumFramesInFlight);
+    m_OffscreenImagesAllocations.resize(m_NumFramesInFlight);
+    for (uint32_t i = 0; i < m_NumFramesInFlight; ++i)
     {
-        VkImageViewCreateInfo CreateInfo{};
-        CreateInfo.sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        CreateInfo.image    = m_SwapchainImages[i];
-        CreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        CreateInfo.format   = m_SwapchainImageFormat;
+        VkImageCreateInfo ImageCreateInfo{};
+        ImageCreateInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        ImageCreateInfo.imageType     = VK_IMAGE_TYPE_2D;
+        ImageCreateInfo.format        = m_SwapchainImageFormat;
+        ImageCreateInfo.extent        = {m_SwapchainExtent.width, m_SwapchainExtent.height, 1};
+        ImageCreateInfo.mipLevels     = 1;
+        ImageCreateInfo.arrayLayers   = 1;
+        ImageCreateInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+        ImageCreateInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+        ImageCreateInfo.usage         = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        ImageCreateInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+        ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-        CreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY; // Default mapping
-        CreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+        if (vkCreateImage(m_VkDevice, &ImageCreateInfo, m_pVkAllocator, &m_SwapchainImages[i]) != VK_SUCCESS)
+        {
+            VKL_CRITICAL("Failed to create offscreen VkImage!");
+            exit(1);
+        }
+
+        VkMemoryRequirements ImageMemoryRequirements{};
+        vkGetImageMemoryRequirements(m_VkDevice, m_SwapchainImages[i], &ImageMemoryRequirements);
+
+        // Blocks are shared with buffers - optimal image must not share bufferImageGranularity page with them
+        VkDeviceSize const Granularity =
+            GetPhysicalDeviceProperties(m_VkPhysicalDevice).limits.bufferImageGranularity;
+        ImageMemoryRequirements.alignment = std::max(ImageMemoryRequirements.alignment, Granularity);
+        ImageMemoryRequirements.size =
+            ((ImageMemoryRequirements.size + Granularity - 1) / Granularity) * Granularity;
+
+        m_OffscreenImagesAllocations[i] =
+            m_DeviceMemoryAllocator.Allocate(ImageMemoryRequirements, MemoryUsage::GpuOnly);
+        vkBindImageMemory(
+            m_VkDevice,
+            m_SwapchainImages[i],
+            m_OffscreenImagesAllocations[i].Memory,
+            m_OffscreenImagesAllocations[i].Offset
+        );
+    }
+    VKL_INFO(
+        "Rendering headless into {} offscreen images {}x{}",
+        m_NumFramesInFlight,
+        m_SwapchainExtent.width,
+        m_SwapchainExtent.height
+    );
+}
+
+void VulkanApp::DestroyOffscreenImages()
+{
+    for (size_t i = 0; i < m_SwapchainImages.size(); ++i)
+    {
+        vkDestroyImage(m_VkDevice, m_SwapchainImages[i], m_pVkAllocator);
+        m_DeviceMemoryAllocator.Free(m_OffscreenImagesAllocations[i]);
+    }
+    m_SwapchainImages.clear();
+    m_OffscreenImagesAllocations.clear();
+    VKL_TRACE("Offscreen VkImages destroyed");
+}
+
+void VulkanApp::CreateSwapchainImagesViews()
+{
+    m_SwapchainImagesViews.resize(m_SwapchainImages.size());
+    for (size_t i = 0; i < m_SwapchainImages.size(); ++i)
+    {
+        VkImageViewCreateInfo CreateInfo{};
+        CreateInfo.sType    = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        CreateInfo.image    = m_SwapchainImages[i];
+        CreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        CreateInfo.format   = m_SwapchainImageFormat;
+
+        CreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY; // Default mapping
+        CreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
         CreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
         CreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 
@@ -1093,7 +1620,8 @@ void VulkanApp::CreateSwapchainImagesViews()
         CreateInfo.subresourceRange.baseArrayLayer = 0;
         CreateInfo.subresourceRange.layerCount     = 1;
 
-        if (vkCreateImageView(m_VkDevice, &CreateInfo, nullptr, &m_SwapchainImagesViews[i]) != VK_SUCCESS)
+        if (vkCreateImageView(m_VkDevice, &CreateInfo, m_pVkAllocator, &m_SwapchainImagesViews[i]) !=
+            VK_SUCCESS)
         {
             VKL_CRITICAL("Failed to create VkImageView!");
             exit(1);
@@ -1106,7 +1634,7 @@ void VulkanApp::DestroySwapchainImagesViews()
 {
     for (VkImageView const &ImageView : m_SwapchainImagesViews)
     {
-        vkDestroyImageView(m_VkDevice, ImageView, nullptr);
+        vkDestroyImageView(m_VkDevice, ImageView, m_pVkAllocator);
     }
     VKL_TRACE("VkImageViews destroyed");
 }
@@ -1121,7 +1649,8 @@ void VulkanApp::CreateRenderPass()
     ColorAttachment.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     ColorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     ColorAttachment.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED;
-    ColorAttachment.finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    ColorAttachment.finalLayout    = m_Settings.bHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL // Readback
+                                                          : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference ColorAttachmentRef{};
     ColorAttachmentRef.attachment = 0; // index of attachment in pAttachments array in RenderPassInfo
@@ -1149,7 +1678,7 @@ void VulkanApp::CreateRenderPass()
     RenderPassInfo.dependencyCount = 1;
     RenderPassInfo.pDependencies   = &Dependency;
 
-    if (vkCreateRenderPass(m_VkDevice, &RenderPassInfo, nullptr, &m_VkRenderPass) != VK_SUCCESS)
+    if (vkCreateRenderPass(m_VkDevice, &RenderPassInfo, m_pVkAllocator, &m_VkRenderPass) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkRenderPass!");
         exit(1);
@@ -1159,7 +1688,7 @@ void VulkanApp::CreateRenderPass()
 
 void VulkanApp::DestroyRenderPass()
 {
-    vkDestroyRenderPass(m_VkDevice, m_VkRenderPass, nullptr);
+    vkDestroyRenderPass(m_VkDevice, m_VkRenderPass, m_pVkAllocator);
     VKL_TRACE("VkRenderPass destroyed");
 }
 
@@ -1186,15 +1715,29 @@ VkPipelineShaderStageCreateInfo VulkanApp::GetFragmentShaderStageInfo(VkShaderMo
     return FragmentShaderStageInfo;
 }
 
-VkPipelineVertexInputStateCreateInfo VulkanApp::GetVertexInputStateInfo()
+VkPipelineVertexInputStateCreateInfo VulkanApp::GetVertexInputStateInfo(bool bInstanced)
 {
-    m_VertexInputBindingDescription    = Vertex::GetInputBindingDescription();
-    m_VertexInputAttributeDescriptions = Vertex::GetInputAttributeDescriptions();
+    auto const VertexAttributes = Vertex::GetInputAttributeDescriptions();
+
+    m_VertexInputBindingDescriptions   = {Vertex::GetInputBindingDescription()};
+    m_VertexInputAttributeDescriptions = {VertexAttributes.begin(), VertexAttributes.end()};
+
+    // Instance rate binding after per-vertex one
+    if (bInstanced)
+    {
+        auto const InstanceAttributes = InstanceData::GetInputAttributeDescriptions();
+
+        m_VertexInputBindingDescriptions.push_back(InstanceData::GetInputBindingDescription());
+        m_VertexInputAttributeDescriptions.insert(
+            m_VertexInputAttributeDescriptions.end(), InstanceAttributes.begin(), InstanceAttributes.end()
+        );
+    }
 
     VkPipelineVertexInputStateCreateInfo VertexInputStageInfo{};
     VertexInputStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    VertexInputStageInfo.vertexBindingDescriptionCount = 1;
-    VertexInputStageInfo.pVertexBindingDescriptions    = &m_VertexInputBindingDescription;
+    VertexInputStageInfo.vertexBindingDescriptionCount =
+        static_cast<uint32_t>(m_VertexInputBindingDescriptions.size());
+    VertexInputStageInfo.pVertexBindingDescriptions = m_VertexInputBindingDescriptions.data();
     VertexInputStageInfo.vertexAttributeDescriptionCount =
         static_cast<uint32_t>(m_VertexInputAttributeDescriptions.size());
     VertexInputStageInfo.pVertexAttributeDescriptions = m_VertexInputAttributeDescriptions.data();
@@ -1342,10 +1885,17 @@ void VulkanApp::CreatePipelineLayout()
     PipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     PipelineLayoutInfo.setLayoutCount         = 1;
     PipelineLayoutInfo.pSetLayouts            = &m_VkMatricesUBOLayout;
-    PipelineLayoutInfo.pushConstantRangeCount = 0;       // optional
-    PipelineLayoutInfo.pPushConstantRanges    = nullptr; // optional
+    // Per-draw object data
+    VkPushConstantRange PushConstantRange{};
+    PushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    PushConstantRange.offset     = 0;
+    PushConstantRange.size       = sizeof(ObjectPushConstants);
+
+    PipelineLayoutInfo.pushConstantRangeCount = 1;
+    PipelineLayoutInfo.pPushConstantRanges    = &PushConstantRange;
 
-    if (vkCreatePipelineLayout(m_VkDevice, &PipelineLayoutInfo, nullptr, &m_VkPipelineLayout) != VK_SUCCESS)
+    if (vkCreatePipelineLayout(m_VkDevice, &PipelineLayoutInfo, m_pVkAllocator, &m_VkPipelineLayout) !=
+        VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkPipelineLayout!");
         exit(1);
@@ -1355,14 +1905,47 @@ void VulkanApp::CreatePipelineLayout()
 
 void VulkanApp::DestroyPipelineLayout()
 {
-    vkDestroyPipelineLayout(m_VkDevice, m_VkPipelineLayout, nullptr);
+    vkDestroyPipelineLayout(m_VkDevice, m_VkPipelineLayout, m_pVkAllocator);
     VKL_TRACE("VkPipelineLayout destroyed");
 }
 
+void VulkanApp::CreatePipelineCache()
+{
+    if (m_Settings.bNoPipelineCache)
+    {
+        return;
+    }
+    m_PipelineCache.Init(
+        m_VkDevice, GetPhysicalDeviceProperties(m_VkPhysicalDevice), s_PipelineCachePath, m_pVkAllocator
+    );
+    VKL_TRACE("Created PipelineCache");
+}
+
+void VulkanApp::DestroyPipelineCache()
+{
+    if (m_Settings.bNoPipelineCache)
+    {
+        return;
+    }
+    m_PipelineCache.Save();
+    m_PipelineCache.Shutdown();
+    VKL_TRACE("PipelineCache destroyed");
+}
+
 void VulkanApp::CreatePipeline()
+{
+    m_VkPipeline = CreateGraphicsPipeline("./Assets/Shaders/vert.spv", false);
+    if (m_Settings.NumInstances > 0)
+    {
+        m_VkInstancedPipeline = CreateGraphicsPipeline("./Assets/Shaders/instanced_vert.spv", true);
+    }
+    VKL_TRACE("Created VkPipeline successfully");
+}
+
+VkPipeline VulkanApp::CreateGraphicsPipeline(std::filesystem::path const &VertexShaderPath, bool bInstanced)
 {
     // Programmable stages
-    std::vector<char> VertexShaderByteCode   = ReadSPIRVByteCode("./Assets/Shaders/vert.spv");
+    std::vector<char> VertexShaderByteCode   = ReadSPIRVByteCode(VertexShaderPath);
     std::vector<char> FragmentShaderByteCode = ReadSPIRVByteCode("./Assets/Shaders/frag.spv");
 
     VkShaderModule VertexShaderModule   = CreateShaderModule(VertexShaderByteCode);
@@ -1375,7 +1958,7 @@ void VulkanApp::CreatePipeline()
     VkPipelineShaderStageCreateInfo ShaderStagesInfo[] = {VertexShaderStageInfo, FragmentShaderStageInfo};
 
     // Fixed stages
-    VkPipelineVertexInputStateCreateInfo   VertexInputStageInfo   = GetVertexInputStateInfo();
+    VkPipelineVertexInputStateCreateInfo   VertexInputStageInfo   = GetVertexInputStateInfo(bInstanced);
     VkPipelineInputAssemblyStateCreateInfo InputAssemblyStageInfo = GetInputAssemblyStateInfo();
 
     // Dynamic Viewport and Scissor
@@ -1424,8 +2007,10 @@ void VulkanApp::CreatePipeline()
     PipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
     PipelineCreateInfo.basePipelineIndex  = -1;
 
-    VkResult PipelineCreateResult =
-        vkCreateGraphicsPipelines(m_VkDevice, VK_NULL_HANDLE, 1, &PipelineCreateInfo, nullptr, &m_VkPipeline);
+    VkPipeline Pipeline             = VK_NULL_HANDLE;
+    VkResult   PipelineCreateResult = vkCreateGraphicsPipelines(
+        m_VkDevice, m_PipelineCache.Get(), 1, &PipelineCreateInfo, m_pVkAllocator, &Pipeline
+    );
 
     DestroyShaderModule(FragmentShaderModule);
     DestroyShaderModule(VertexShaderModule);
@@ -1435,15 +2020,40 @@ void VulkanApp::CreatePipeline()
         VKL_CRITICAL("Failed to create VkPipeline!");
         exit(1);
     }
-    VKL_TRACE("Created VkPipeline successfully");
+    return Pipeline;
 }
 
 void VulkanApp::DestroyPipeline()
 {
-    vkDestroyPipeline(m_VkDevice, m_VkPipeline, nullptr);
+    vkDestroyPipeline(m_VkDevice, m_VkInstancedPipeline, m_pVkAllocator);
+    vkDestroyPipeline(m_VkDevice, m_VkPipeline, m_pVkAllocator);
     VKL_TRACE("VkPipeline destroyed");
 }
 
+void VulkanApp::RecreatePipeline()
+{
+    auto const StartTime = std::chrono::high_resolution_clock::now();
+
+    // Frames in flight still use the old one
+    VkPipeline const OldPipeline          = m_VkPipeline;
+    VkPipeline const OldInstancedPipeline = m_VkInstancedPipeline;
+    RetireResource(
+        [this, OldPipeline, OldInstancedPipeline]()
+        {
+            vkDestroyPipeline(m_VkDevice, OldInstancedPipeline, m_pVkAllocator);
+            vkDestroyPipeline(m_VkDevice, OldPipeline, m_pVkAllocator);
+        }
+    );
+
+    CreatePipeline();
+    m_CommandBufferCache.Invalidate();
+
+    auto const  EndTime = std::chrono::high_resolution_clock::now();
+    float const ElapsedMs =
+        std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(EndTime - StartTime).count();
+    VKL_INFO("VkPipeline recreated in {:.2f} ms", ElapsedMs);
+}
+
 std::vector<char> VulkanApp::ReadSPIRVByteCode(std::filesystem::path const &FilePath) const
 {
     std::ifstream File(FilePath, std::ios::ate | std::ios::binary);
@@ -1466,7 +2076,7 @@ VkShaderModule VulkanApp::CreateShaderModule(std::vector<char> const &SPIRVByteC
     CreateInfo.pCode    = reinterpret_cast<uint32_t const *>(SPIRVByteCode.data());
 
     VkShaderModule ShaderModule{};
-    if (vkCreateShaderModule(m_VkDevice, &CreateInfo, nullptr, &ShaderModule) != VK_SUCCESS)
+    if (vkCreateShaderModule(m_VkDevice, &CreateInfo, m_pVkAllocator, &ShaderModule) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkShaderModule!");
         exit(1);
@@ -1476,7 +2086,7 @@ VkShaderModule VulkanApp::CreateShaderModule(std::vector<char> const &SPIRVByteC
 
 void VulkanApp::DestroyShaderModule(VkShaderModule ShaderModule) const
 {
-    vkDestroyShaderModule(m_VkDevice, ShaderModule, nullptr);
+    vkDestroyShaderModule(m_VkDevice, ShaderModule, m_pVkAllocator);
 }
 
 void VulkanApp::CreateFramebuffers()
@@ -1496,7 +2106,8 @@ void VulkanApp::CreateFramebuffers()
         FramebufferInfo.height          = m_SwapchainExtent.height;
         FramebufferInfo.layers          = 1;
 
-        if (vkCreateFramebuffer(m_VkDevice, &FramebufferInfo, nullptr, &m_VkFramebuffers[i]) != VK_SUCCESS)
+        if (vkCreateFramebuffer(m_VkDevice, &FramebufferInfo, m_pVkAllocator, &m_VkFramebuffers[i]) !=
+            VK_SUCCESS)
         {
             VKL_CRITICAL("Failed to create VkFramebuffer!");
             exit(1);
@@ -1509,17 +2120,30 @@ void VulkanApp::DestroyFramebuffers()
 {
     for (size_t i = 0; i < m_VkFramebuffers.size(); ++i)
     {
-        vkDestroyFramebuffer(m_VkDevice, m_VkFramebuffers[i], nullptr);
+        vkDestroyFramebuffer(m_VkDevice, m_VkFramebuffers[i], m_pVkAllocator);
     }
     VKL_TRACE("VkFramebuffers destroyed");
 }
 
+void VulkanApp::CreateDeviceMemoryAllocator()
+{
+    m_MemoryBudgetTracker.Init(m_VkPhysicalDevice, m_bMemoryBudgetSupported);
+    m_DeviceMemoryAllocator.Init(m_VkDevice, &m_MemoryPolicy, &m_MemoryBudgetTracker, m_pVkAllocator);
+}
+
+void VulkanApp::DestroyDeviceMemoryAllocator()
+{
+    m_DeviceMemoryAllocator.LogStats();
+    m_MemoryBudgetTracker.LogBudgets();
+    m_DeviceMemoryAllocator.Shutdown();
+}
+
 void VulkanApp::CreateBuffer(
-    VkBuffer             &Buffer,
-    VkDeviceMemory       &BufferMemory,
-    VkBufferUsageFlags    Usage,
-    VkDeviceSize          Size,
-    VkMemoryPropertyFlags Properties
+    VkBuffer               &Buffer,
+    DeviceMemoryAllocation &BufferAllocation,
+    VkBufferUsageFlags      Usage,
+    VkDeviceSize            Size,
+    MemoryUsage             MemoryIntent
 )
 {
     VkBufferCreateInfo BufferCreateInfo{};
@@ -1528,7 +2152,7 @@ void VulkanApp::CreateBuffer(
     BufferCreateInfo.size        = Size;
     BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE; // only will be used by graphics queue
 
-    if (vkCreateBuffer(m_VkDevice, &BufferCreateInfo, nullptr, &Buffer) != VK_SUCCESS)
+    if (vkCreateBuffer(m_VkDevice, &BufferCreateInfo, m_pVkAllocator, &Buffer) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkBuffer!");
         exit(1);
@@ -1538,48 +2162,45 @@ void VulkanApp::CreateBuffer(
     VkMemoryRequirements BufferMemoryRequirements{};
     vkGetBufferMemoryRequirements(m_VkDevice, Buffer, &BufferMemoryRequirements);
 
-    VkPhysicalDeviceMemoryProperties PhysicalDeviceMemoryProperties{};
-    vkGetPhysicalDeviceMemoryProperties(m_VkPhysicalDevice, &PhysicalDeviceMemoryProperties);
-
-    auto FindMemoryType =
-        [PhysicalDeviceMemoryProperties](uint32_t TypeFilter, VkMemoryPropertyFlags Properties)
-    {
-        for (uint32_t i = 0; i < PhysicalDeviceMemoryProperties.memoryTypeCount; ++i)
-        {
-            if ((TypeFilter & (1 << i)) &&
-                (Properties & PhysicalDeviceMemoryProperties.memoryTypes[i].propertyFlags) == Properties)
-            {
-                return i;
-            }
-        }
+    // Sub-range of shared VkDeviceMemory block, alignment is handled by allocator
+    BufferAllocation = m_DeviceMemoryAllocator.Allocate(BufferMemoryRequirements, MemoryIntent);
 
-        VKL_CRITICAL("Required memory block not found for VkBuffer!");
-        exit(1);
-    };
+    vkBindBufferMemory(m_VkDevice, Buffer, BufferAllocation.Memory, BufferAllocation.Offset);
+}
 
-    VkMemoryAllocateInfo BufferMemoryAllocateInfo{};
-    BufferMemoryAllocateInfo.sType          = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    BufferMemoryAllocateInfo.allocationSize = BufferMemoryRequirements.size;
-    BufferMemoryAllocateInfo.memoryTypeIndex =
-        FindMemoryType(BufferMemoryRequirements.memoryTypeBits, Properties);
+void VulkanApp::DestroyBuffer(VkBuffer &Buffer, DeviceMemoryAllocation &BufferAllocation)
+{
+    m_UploadBatch.ForgetBuffer(Buffer); // Could be destroyed before graphics queue acquired it
+    vkDestroyBuffer(m_VkDevice, Buffer, m_pVkAllocator);
+    m_DeviceMemoryAllocator.Free(BufferAllocation);
+}
 
-    if (vkAllocateMemory(m_VkDevice, &BufferMemoryAllocateInfo, nullptr, &BufferMemory) != VK_SUCCESS)
-    {
-        VKL_CRITICAL("Failed to allocate VkDeviceMemory!");
-        exit(1);
-    }
-    VKL_TRACE("Allocated VkDeviceMemory successfully");
+void VulkanApp::RetireBuffer(VkBuffer &Buffer, DeviceMemoryAllocation &BufferAllocation)
+{
+    RetireResource([this, Buffer, BufferAllocation]() mutable { DestroyBuffer(Buffer, BufferAllocation); });
+    Buffer           = VK_NULL_HANDLE;
+    BufferAllocation = {};
+}
 
-    vkBindBufferMemory(m_VkDevice, Buffer, BufferMemory, 0);
+void VulkanApp::CreateGeometryBuffer()
+{
+    m_GeometryBuffer.Init(
+        m_VkDevice,
+        &m_DeviceMemoryAllocator,
+        &m_UploadBatch,
+        &m_DeletionQueue,
+        &m_GraphicsTimeline,
+        m_pVkAllocator
+    );
 }
 
-void VulkanApp::DestroyBuffer(VkBuffer &Buffer, VkDeviceMemory &BufferMemory)
+void VulkanApp::DestroyGeometryBuffer()
 {
-    vkDestroyBuffer(m_VkDevice, Buffer, nullptr);
-    vkFreeMemory(m_VkDevice, BufferMemory, nullptr);
+    m_GeometryBuffer.LogStats();
+    m_GeometryBuffer.Shutdown();
 }
 
-void VulkanApp::CreateVertexBuffer()
+void VulkanApp::CreateCubeMesh()
 {
     // clang-format off
     m_Vertices = {
@@ -1594,44 +2215,6 @@ void VulkanApp::CreateVertexBuffer()
     };
     // clang-format on
 
-    VkDeviceSize BufferSize = static_cast<VkDeviceSize>(sizeof(m_Vertices[0]) * m_Vertices.size());
-
-    VkBuffer       StagingBuffer{};
-    VkDeviceMemory StagingBufferMemory{};
-
-    CreateBuffer(
-        StagingBuffer,
-        StagingBufferMemory,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        BufferSize,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    );
-
-    void *StagingBufferData = nullptr;
-    vkMapMemory(m_VkDevice, StagingBufferMemory, 0, BufferSize, 0, &StagingBufferData);
-    std::memcpy(StagingBufferData, m_Vertices.data(), static_cast<size_t>(BufferSize));
-    vkUnmapMemory(m_VkDevice, StagingBufferMemory);
-
-    CreateBuffer(
-        m_VkVertexBuffer,
-        m_VkVertexBufferMemory,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        BufferSize,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-    );
-
-    TransferBufferData(StagingBuffer, m_VkVertexBuffer, BufferSize);
-
-    DestroyBuffer(StagingBuffer, StagingBufferMemory);
-}
-
-void VulkanApp::DestroyVertexBuffer()
-{
-    DestroyBuffer(m_VkVertexBuffer, m_VkVertexBufferMemory);
-}
-
-void VulkanApp::CreateIndexBuffer()
-{
     // clang-format off
     m_Indices = {
         4, 2, 0,
@@ -1649,98 +2232,226 @@ void VulkanApp::CreateIndexBuffer()
     };
     // clang-format on
 
-    VkDeviceSize BufferSize = static_cast<VkDeviceSize>(sizeof(m_Indices[0]) * m_Indices.size());
+    m_CubeMesh = m_GeometryBuffer.AddMesh(m_Vertices, m_Indices);
+    SceneObject Cube{};
+    Cube.Mesh          = m_CubeMesh;
+    Cube.InstanceCount = m_Settings.NumInstances;
 
-    VkBuffer       StagingBuffer{};
-    VkDeviceMemory StagingBufferMemory{};
+    if (m_SceneObjects.size() >= ObjectsUBO::s_MaxObjects)
+    {
+        VKL_CRITICAL("ObjectsUBO can't hold more than {} objects!", ObjectsUBO::s_MaxObjects);
+        exit(1);
+    }
+    m_CubeObjectIndex = static_cast<uint32_t>(m_SceneObjects.size());
+    m_SceneObjects.push_back(Cube);
+    m_CommandBufferCache.Invalidate();
+    m_bSceneDirty = true;
+}
+
+void VulkanApp::CreateInstanceBuffer()
+{
+    uint32_t const NumInstances = m_Settings.NumInstances;
+    if (NumInstances == 0)
+    {
+        return;
+    }
+
+    // Cube of cubes going away from camera, spaced so rotating ones don't intersect
+    constexpr float Spacing  = 4.0f;
+    uint32_t const  GridSize = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<float>(NumInstances))));
+    float const     HalfSize = 0.5f * Spacing * static_cast<float>(GridSize - 1);
 
+    std::vector<InstanceData> Instances(NumInstances);
+    for (uint32_t i = 0; i < NumInstances; ++i)
+    {
+        glm::vec3 const Cell{
+            static_cast<float>(i % GridSize),
+            static_cast<float>(i / GridSize % GridSize),
+            static_cast<float>(i / (GridSize * GridSize))
+        };
+        glm::vec3 const Offset{Cell.x * Spacing - HalfSize, Cell.y * Spacing - HalfSize, -Cell.z * Spacing};
+        Instances[i].Model = glm::translate(glm::mat4(1.0f), Offset);
+    }
+
+    VkDeviceSize const Size = sizeof(InstanceData) * Instances.size();
     CreateBuffer(
-        StagingBuffer,
-        StagingBufferMemory,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        BufferSize,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        m_VkInstanceBuffer,
+        m_InstanceBufferAllocation,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        Size,
+        MemoryUsage::GpuOnly
     );
+    m_UploadBatch.UploadBuffer(m_VkInstanceBuffer, Instances.data(), Size);
+
+    VKL_TRACE("Created instance buffer: {} instances in {}^3 grid", NumInstances, GridSize);
+}
+
+void VulkanApp::DestroyInstanceBuffer()
+{
+    if (m_Settings.NumInstances == 0)
+    {
+        return;
+    }
+    DestroyBuffer(m_VkInstanceBuffer, m_InstanceBufferAllocation);
+}
+
+void VulkanApp::CreateIndirectDrawBuffers()
+{
+    if (!m_Settings.bIndirectDraws)
+    {
+        return;
+    }
+    m_IndirectDrawBuffers.resize(m_NumFramesInFlight);
+    for (IndirectDrawBuffer &IndirectBuffer : m_IndirectDrawBuffers)
+    {
+        IndirectBuffer.Init(
+            m_VkDevice, &m_DeviceMemoryAllocator, &m_DeletionQueue, &m_GraphicsTimeline, m_pVkAllocator
+        );
+    }
+    VKL_TRACE("Created IndirectDrawBuffers");
+}
 
-    void *StagingBufferData = nullptr;
-    vkMapMemory(m_VkDevice, StagingBufferMemory, 0, BufferSize, 0, &StagingBufferData);
-    std::memcpy(StagingBufferData, m_Indices.data(), static_cast<size_t>(BufferSize));
-    vkUnmapMemory(m_VkDevice, StagingBufferMemory);
+void VulkanApp::DestroyIndirectDrawBuffers()
+{
+    if (!m_Settings.bIndirectDraws)
+    {
+        return;
+    }
+    for (IndirectDrawBuffer &IndirectBuffer : m_IndirectDrawBuffers)
+    {
+        IndirectBuffer.Shutdown();
+    }
+    VKL_TRACE("IndirectDrawBuffers destroyed");
+}
 
+void VulkanApp::CreateUploadBatch()
+{
     CreateBuffer(
-        m_VkIndexBuffer,
-        m_VkIndexBufferMemory,
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        BufferSize,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        m_VkStagingBuffer,
+        m_StagingBufferAllocation,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        StagingRing::s_DefaultSize,
+        MemoryUsage::Upload
     );
 
-    TransferBufferData(StagingBuffer, m_VkIndexBuffer, BufferSize);
+    // Upload memory is always HOST_VISIBLE, so allocation is mapped for its whole lifetime
+    m_StagingRing.Init(m_VkStagingBuffer, m_StagingBufferAllocation.MappedData, StagingRing::s_DefaultSize);
 
-    DestroyBuffer(StagingBuffer, StagingBufferMemory);
+    m_UploadBatch.Init(
+        m_VkDevice,
+        m_VkTransferQueue,
+        m_QueueFamilyIndices.TransferFamily.value(),
+        m_QueueFamilyIndices.GraphicsFamily.value(),
+        m_VkTransferCommandPool,
+        &m_TransferTimeline,
+        &m_StagingRing
+    );
+    VKL_TRACE("Created staging ring of {} KB successfully", StagingRing::s_DefaultSize / 1024);
 }
 
-void VulkanApp::DestroyIndexBuffer()
+void VulkanApp::DestroyUploadBatch()
 {
-    vkDestroyBuffer(m_VkDevice, m_VkIndexBuffer, nullptr);
-    vkFreeMemory(m_VkDevice, m_VkIndexBufferMemory, nullptr);
+    m_UploadBatch.Shutdown();
+
+    DestroyBuffer(m_VkStagingBuffer, m_StagingBufferAllocation);
+    VKL_TRACE("Staging ring destroyed");
 }
 
-void VulkanApp::TransferBufferData(VkBuffer Source, VkBuffer Destination, VkDeviceSize Size)
+void VulkanApp::RunUploadBenchmark()
 {
-    VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
-    CommandBufferAllocateInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    CommandBufferAllocateInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    CommandBufferAllocateInfo.commandPool        = m_VkTransferCommandPool;
-    CommandBufferAllocateInfo.commandBufferCount = 1;
+    constexpr uint32_t NumMeshes = 1000;
 
-    VkCommandBuffer TransferCommandBuffer;
-    if (vkAllocateCommandBuffers(m_VkDevice, &CommandBufferAllocateInfo, &TransferCommandBuffer) !=
-        VK_SUCCESS)
-    {
-        VKL_CRITICAL("Failed to create transfer command buffer!");
-        exit(1);
-    }
+    VkDeviceSize const VertexBufferSize = sizeof(m_Vertices[0]) * m_Vertices.size();
+    VkDeviceSize const IndexBufferSize  = sizeof(m_Indices[0]) * m_Indices.size();
+
+    std::vector<VkBuffer>               MeshBuffers(2 * NumMeshes);
+    std::vector<DeviceMemoryAllocation> MeshBuffersAllocations(2 * NumMeshes);
 
-    VkCommandBufferBeginInfo TransferBeginInfo{};
-    TransferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    TransferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(TransferCommandBuffer, &TransferBeginInfo);
+    // Every mesh is a copy of the cube: vertex buffer at 2 * i, index buffer at 2 * i + 1
+    auto const MeasureUploads = [&](bool bBatched) {
+        for (uint32_t i = 0; i < NumMeshes; ++i)
+        {
+            CreateBuffer(
+                MeshBuffers[2 * i],
+                MeshBuffersAllocations[2 * i],
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VertexBufferSize,
+                MemoryUsage::GpuOnly
+            );
+            CreateBuffer(
+                MeshBuffers[2 * i + 1],
+                MeshBuffersAllocations[2 * i + 1],
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                IndexBufferSize,
+                MemoryUsage::GpuOnly
+            );
+        }
 
-    VkBufferCopy TransferInfo{};
-    TransferInfo.srcOffset = 0;
-    TransferInfo.dstOffset = 0;
-    TransferInfo.size      = Size;
-    vkCmdCopyBuffer(TransferCommandBuffer, Source, Destination, 1, &TransferInfo);
+        uint64_t const NumSubmissionsBefore = m_UploadBatch.GetNumSubmissions();
+        auto const     StartTime            = std::chrono::high_resolution_clock::now();
 
-    vkEndCommandBuffer(TransferCommandBuffer);
+        for (uint32_t i = 0; i < NumMeshes; ++i)
+        {
+            // One by one is the old way: one submission and one wait for every buffer
+            m_UploadBatch.UploadBuffer(MeshBuffers[2 * i], m_Vertices.data(), VertexBufferSize);
+            if (!bBatched)
+            {
+                m_UploadBatch.WaitIdle();
+            }
+
+            m_UploadBatch.UploadBuffer(MeshBuffers[2 * i + 1], m_Indices.data(), IndexBufferSize);
+            if (!bBatched)
+            {
+                m_UploadBatch.WaitIdle();
+            }
+        }
+        m_UploadBatch.WaitIdle();
+
+        auto const  EndTime = std::chrono::high_resolution_clock::now();
+        float const ElapsedMs =
+            std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(EndTime - StartTime).count();
+
+        VKL_INFO(
+            "Upload benchmark: {} meshes {} - {:.2f} ms, {} submissions",
+            NumMeshes,
+            bBatched ? "batched" : "one by one",
+            ElapsedMs,
+            m_UploadBatch.GetNumSubmissions() - NumSubmissionsBefore
+        );
 
-    VkSubmitInfo TransferSubmitInfo{};
-    TransferSubmitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    TransferSubmitInfo.commandBufferCount = 1;
-    TransferSubmitInfo.pCommandBuffers    = &TransferCommandBuffer;
-    vkQueueSubmit(m_VkGraphicsQueue, 1, &TransferSubmitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(m_VkGraphicsQueue);
+        for (uint32_t i = 0; i < 2 * NumMeshes; ++i)
+        {
+            DestroyBuffer(MeshBuffers[i], MeshBuffersAllocations[i]);
+        }
+    };
 
-    vkFreeCommandBuffers(m_VkDevice, m_VkTransferCommandPool, 1, &TransferCommandBuffer);
+    MeasureUploads(false);
+    MeasureUploads(true);
 }
 
 void VulkanApp::CreateDescriptorSetLayout()
 {
     VkDescriptorSetLayoutBinding MatricesUBOLayoutBinding{};
     MatricesUBOLayoutBinding.binding            = 0;
-    MatricesUBOLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    MatricesUBOLayoutBinding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     MatricesUBOLayoutBinding.descriptorCount    = 1;
     MatricesUBOLayoutBinding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
     MatricesUBOLayoutBinding.pImmutableSamplers = nullptr; // not needed here
 
+    // Same frame arena, own dynamic offset
+    VkDescriptorSetLayoutBinding ObjectsUBOLayoutBinding = MatricesUBOLayoutBinding;
+    ObjectsUBOLayoutBinding.binding                      = 1;
+
+    VkDescriptorSetLayoutBinding const LayoutBindings[] = {MatricesUBOLayoutBinding, ObjectsUBOLayoutBinding};
+
     VkDescriptorSetLayoutCreateInfo DescriptorSetLayoutInfo{};
     DescriptorSetLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    DescriptorSetLayoutInfo.bindingCount = 1;
-    DescriptorSetLayoutInfo.pBindings    = &MatricesUBOLayoutBinding;
+    DescriptorSetLayoutInfo.bindingCount = 2;
+    DescriptorSetLayoutInfo.pBindings    = LayoutBindings;
 
-    if (vkCreateDescriptorSetLayout(m_VkDevice, &DescriptorSetLayoutInfo, nullptr, &m_VkMatricesUBOLayout) !=
-        VK_SUCCESS)
+    if (vkCreateDescriptorSetLayout(
+            m_VkDevice, &DescriptorSetLayoutInfo, m_pVkAllocator, &m_VkMatricesUBOLayout
+        ) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkDescriptorSetLayout!");
         exit(1);
@@ -1750,33 +2461,70 @@ void VulkanApp::CreateDescriptorSetLayout()
 
 void VulkanApp::DestroyDescriptorSetLayout()
 {
-    vkDestroyDescriptorSetLayout(m_VkDevice, m_VkMatricesUBOLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_VkDevice, m_VkMatricesUBOLayout, m_pVkAllocator);
 }
 
-void VulkanApp::CreateUniformBuffers()
+void VulkanApp::CreateUniformArenas()
 {
-    static constexpr VkDeviceSize UBOSize = sizeof(MatricesUBO);
+    VkDeviceSize const Alignment =
+        GetPhysicalDeviceProperties(m_VkPhysicalDevice).limits.minUniformBufferOffsetAlignment;
 
-    for (uint32_t i = 0; i < s_FramesInFlight; ++i)
+    m_VkUniformArenaBuffers.resize(m_NumFramesInFlight);
+    m_UniformArenaAllocations.resize(m_NumFramesInFlight);
+    m_UniformArenas.resize(m_NumFramesInFlight);
+    for (uint32_t i = 0; i < m_NumFramesInFlight; ++i)
     {
         CreateBuffer(
-            m_VkMatricesUBOs[i],
-            m_VkMatricesUBOsMemory[i],
+            m_VkUniformArenaBuffers[i],
+            m_UniformArenaAllocations[i],
             VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            UBOSize,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+            UniformArena::s_DefaultSize,
+            MemoryUsage::PerFrameDynamic
+        );
+
+        if (!m_UniformArenaAllocations[i].MappedData)
+        {
+            VKL_CRITICAL("Uniform arena memory is not host visible!");
+            exit(1);
+        }
+        m_UniformArenas[i].Init(
+            m_VkUniformArenaBuffers[i],
+            m_UniformArenaAllocations[i].MappedData,
+            UniformArena::s_DefaultSize,
+            Alignment
         );
+    }
+    VKL_TRACE(
+        "Created uniform arenas of {} bytes, {} bytes alignment", UniformArena::s_DefaultSize, Alignment
+    );
+}
 
-        vkMapMemory(m_VkDevice, m_VkMatricesUBOsMemory[i], 0, UBOSize, 0, &m_MatricesUBOsMappedMemory[i]);
+void VulkanApp::DestroyUniformArenas()
+{
+    for (uint32_t i = 0; i < m_NumFramesInFlight; ++i)
+    {
+        VKL_TRACE(
+            "Uniform arena {} used at most {} of {} bytes",
+            i,
+            m_UniformArenas[i].GetPeakUsedSize(),
+            m_UniformArenas[i].GetSize()
+        );
+        DestroyBuffer(m_VkUniformArenaBuffers[i], m_UniformArenaAllocations[i]);
     }
 }
 
-void VulkanApp::DestroyUniformBuffers()
+void VulkanApp::UpdateSceneObjects(float ElapsedTime)
 {
-    for (uint32_t i = 0; i < s_FramesInFlight; ++i)
+    m_SceneTime += ElapsedTime;
+
+    glm::mat4 ModelMatrix = glm::rotate(glm::mat4(1.0f), m_SceneTime, glm::vec3{1.0f, 0.5f, 0.2f});
+    ModelMatrix = glm::translate(glm::mat4(1.0f), m_CubePosition) * ModelMatrix;
+
+    SceneObject &Cube = m_SceneObjects[m_CubeObjectIndex];
+    if (Cube.Model != ModelMatrix)
     {
-        vkDestroyBuffer(m_VkDevice, m_VkMatricesUBOs[i], nullptr);
-        vkFreeMemory(m_VkDevice, m_VkMatricesUBOsMemory[i], nullptr);
+        Cube.Model    = ModelMatrix;
+        m_bSceneDirty = true;
     }
 }
 
@@ -1789,30 +2537,45 @@ void VulkanApp::UpdateUniformBuffers()
     // But this flips CW and CCW polygon rotation
     CameraProjection[1][1] *= -1;
 
-    glm::mat4 ModelMatrix =
-        glm::rotate(glm::mat4(1.0f), static_cast<float>(glfwGetTime()), glm::vec3{1.0f, 0.5f, 0.2f});
-    ModelMatrix = glm::translate(glm::mat4(1.0f), glm::vec3{0.0f, 0.0f, -3.0f}) * ModelMatrix;
-
     MatricesUBO UBOData{};
-    UBOData.Model          = ModelMatrix;
     UBOData.ProjectionView = CameraProjection * CameraView;
 
-    std::memcpy(m_MatricesUBOsMappedMemory[m_CurrentFrame], &UBOData, sizeof(UBOData));
+    UniformArena &Arena = m_UniformArenas[m_CurrentFrame];
+    Arena.Reset();
+
+    std::optional<uint32_t> const Offset = Arena.Write(UBOData);
+
+    // Whole block is allocated even if fewer objects are written - offset mustn't depend on their number
+    std::optional<UniformRegion> const ObjectsRegion = Arena.Allocate(sizeof(ObjectsUBO));
+    if (!Offset || !ObjectsRegion)
+    {
+        VKL_CRITICAL("Uniform arena is out of space!");
+        exit(1);
+    }
+    m_MatricesUBOOffset = *Offset;
+    m_ObjectsUBOOffset  = ObjectsRegion->DynamicOffset;
+
+    glm::mat4 *Models = static_cast<ObjectsUBO *>(ObjectsRegion->MappedData)->Models;
+    for (size_t i = 0; i < m_SceneObjects.size(); ++i)
+    {
+        Models[i] = m_SceneObjects[i].Model;
+    }
 }
 
 void VulkanApp::CreateDescriptorPool()
 {
     VkDescriptorPoolSize DescriptorPoolSize{};
-    DescriptorPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    DescriptorPoolSize.descriptorCount = static_cast<uint32_t>(s_FramesInFlight);
+    DescriptorPoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    DescriptorPoolSize.descriptorCount = 2 * m_NumFramesInFlight; // MatricesUBO and ObjectsUBO per frame
 
     VkDescriptorPoolCreateInfo DescriptorPoolInfo{};
     DescriptorPoolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     DescriptorPoolInfo.poolSizeCount = 1;
     DescriptorPoolInfo.pPoolSizes    = &DescriptorPoolSize;
-    DescriptorPoolInfo.maxSets       = static_cast<uint32_t>(s_FramesInFlight);
+    DescriptorPoolInfo.maxSets       = m_NumFramesInFlight;
 
-    if (vkCreateDescriptorPool(m_VkDevice, &DescriptorPoolInfo, nullptr, &m_VkDescriptorPool) != VK_SUCCESS)
+    if (vkCreateDescriptorPool(m_VkDevice, &DescriptorPoolInfo, m_pVkAllocator, &m_VkDescriptorPool) !=
+        VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkDescriptorPool!");
         exit(1);
@@ -1822,18 +2585,18 @@ void VulkanApp::CreateDescriptorPool()
 
 void VulkanApp::DestroyDescriptorPool()
 {
-    vkDestroyDescriptorPool(m_VkDevice, m_VkDescriptorPool, nullptr);
+    vkDestroyDescriptorPool(m_VkDevice, m_VkDescriptorPool, m_pVkAllocator);
 }
 
 void VulkanApp::AllocateDescriptorSets()
 {
-    std::array<VkDescriptorSetLayout, s_FramesInFlight> SetsLayouts{};
-    SetsLayouts.fill(m_VkMatricesUBOLayout);
+    std::vector<VkDescriptorSetLayout> const SetsLayouts(m_NumFramesInFlight, m_VkMatricesUBOLayout);
+    m_VkDescriptorSets.resize(m_NumFramesInFlight);
 
     VkDescriptorSetAllocateInfo DescriptorSetInfo{};
     DescriptorSetInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     DescriptorSetInfo.descriptorPool     = m_VkDescriptorPool;
-    DescriptorSetInfo.descriptorSetCount = static_cast<uint32_t>(s_FramesInFlight);
+    DescriptorSetInfo.descriptorSetCount = m_NumFramesInFlight;
     DescriptorSetInfo.pSetLayouts        = SetsLayouts.data();
 
     if (vkAllocateDescriptorSets(m_VkDevice, &DescriptorSetInfo, m_VkDescriptorSets.data()) != VK_SUCCESS)
@@ -1843,81 +2606,145 @@ void VulkanApp::AllocateDescriptorSets()
     }
     VKL_TRACE("Allocated VkDescriptorSets successfully");
 
-    for (uint32_t i = 0; i < s_FramesInFlight; ++i)
+    for (uint32_t i = 0; i < m_NumFramesInFlight; ++i)
     {
+        // Offset comes with binding, range is size of one block
         VkDescriptorBufferInfo DescriptorBufferInfo{};
-        DescriptorBufferInfo.buffer = m_VkMatricesUBOs[i];
+        DescriptorBufferInfo.buffer = m_VkUniformArenaBuffers[i];
         DescriptorBufferInfo.offset = 0;
         DescriptorBufferInfo.range  = sizeof(MatricesUBO);
 
+        VkDescriptorBufferInfo ObjectsBufferInfo = DescriptorBufferInfo;
+        ObjectsBufferInfo.range                  = sizeof(ObjectsUBO);
+
         VkWriteDescriptorSet DescriptorSetWrite{};
         DescriptorSetWrite.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         DescriptorSetWrite.dstSet           = m_VkDescriptorSets[i];
         DescriptorSetWrite.dstBinding       = 0;
         DescriptorSetWrite.dstArrayElement  = 0;
-        DescriptorSetWrite.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        DescriptorSetWrite.descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         DescriptorSetWrite.descriptorCount  = 1;
         DescriptorSetWrite.pBufferInfo      = &DescriptorBufferInfo;
         DescriptorSetWrite.pImageInfo       = nullptr;
         DescriptorSetWrite.pTexelBufferView = nullptr;
 
-        vkUpdateDescriptorSets(m_VkDevice, 1, &DescriptorSetWrite, 0, nullptr);
+        VkWriteDescriptorSet ObjectsSetWrite = DescriptorSetWrite;
+        ObjectsSetWrite.dstBinding           = 1;
+        ObjectsSetWrite.pBufferInfo          = &ObjectsBufferInfo;
+
+        VkWriteDescriptorSet const DescriptorSetWrites[] = {DescriptorSetWrite, ObjectsSetWrite};
+        vkUpdateDescriptorSets(m_VkDevice, 2, DescriptorSetWrites, 0, nullptr);
     }
 }
 
 void VulkanApp::CreateCommandPool()
 {
-    VkCommandPoolCreateInfo CommandPoolInfo{};
-    CommandPoolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    CommandPoolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    CommandPoolInfo.queueFamilyIndex = m_QueueFamilyIndices.GraphicsFamily.value();
-
-    if (vkCreateCommandPool(m_VkDevice, &CommandPoolInfo, nullptr, &m_VkCommandPool) != VK_SUCCESS)
-    {
-        VKL_CRITICAL("Failed to create VkCommandPool!");
-        exit(1);
-    }
-
+    // Graphics pools belong to FrameContexts
     VkCommandPoolCreateInfo TransferCommandPoolInfo{};
     TransferCommandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     TransferCommandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
-    TransferCommandPoolInfo.queueFamilyIndex =
-        m_QueueFamilyIndices.GraphicsFamily.value(); // Graphics queue family always supports transfer bit
+    TransferCommandPoolInfo.queueFamilyIndex = m_QueueFamilyIndices.TransferFamily.value();
 
-    if (vkCreateCommandPool(m_VkDevice, &TransferCommandPoolInfo, nullptr, &m_VkTransferCommandPool) !=
+    if (vkCreateCommandPool(m_VkDevice, &TransferCommandPoolInfo, m_pVkAllocator, &m_VkTransferCommandPool) !=
         VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to create VkCommandPool!");
         exit(1);
     }
-    VKL_TRACE("Created VkCommandPools successfully");
+    VKL_TRACE("Created VkCommandPool successfully");
 }
 
 void VulkanApp::DestroyCommandPool()
 {
-    vkDestroyCommandPool(m_VkDevice, m_VkCommandPool, nullptr);
-    vkDestroyCommandPool(m_VkDevice, m_VkTransferCommandPool, nullptr);
-    VKL_TRACE("VkCommandPools destroyed");
+    vkDestroyCommandPool(m_VkDevice, m_VkTransferCommandPool, m_pVkAllocator);
+    VKL_TRACE("VkCommandPool destroyed");
+}
+
+void VulkanApp::CreateRecordingWorkers()
+{
+    if (m_Settings.NumRecordingThreads == 0 && !m_Settings.bBenchmarkRecording)
+    {
+        return;
+    }
+
+    uint32_t const NumWorkers = m_Settings.NumRecordingThreads > 0 ? m_Settings.NumRecordingThreads
+                                                                   : std::thread::hardware_concurrency();
+    m_RecordingWorkers = std::make_unique<WorkerPool>(NumWorkers);
+    VKL_TRACE("Created {} recording workers", m_RecordingWorkers->GetNumWorkers());
+}
+
+void VulkanApp::DestroyRecordingWorkers()
+{
+    if (!m_RecordingWorkers)
+    {
+        return;
+    }
+    m_RecordingWorkers.reset();
+    VKL_TRACE("Recording workers destroyed");
 }
 
-void VulkanApp::AllocateCommandBuffers()
+void VulkanApp::CreateFrameContexts()
 {
-    VkCommandBufferAllocateInfo CommandBufferInfo{};
-    CommandBufferInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    CommandBufferInfo.commandPool        = m_VkCommandPool;
-    CommandBufferInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    CommandBufferInfo.commandBufferCount = static_cast<uint32_t>(m_VkCommandBuffers.size());
+    // Main thread and every worker need own pool - pools are externally synchronized
+    uint32_t const NumThreads = 1 + (m_RecordingWorkers ? m_RecordingWorkers->GetNumWorkers() : 0);
 
-    if (vkAllocateCommandBuffers(m_VkDevice, &CommandBufferInfo, m_VkCommandBuffers.data()) != VK_SUCCESS)
+    m_FrameContexts.resize(m_NumFramesInFlight);
+    m_FramesOwnershipAcquires.resize(m_NumFramesInFlight);
+    for (FrameContext &Frame : m_FrameContexts)
     {
-        VKL_CRITICAL("Failed to allocate VkCommandBuffer!");
-        exit(1);
+        Frame.Init(m_VkDevice, m_QueueFamilyIndices.GraphicsFamily.value(), NumThreads, m_pVkAllocator);
     }
-    VKL_TRACE("Allocated VkCommandBuffers successfully");
+    VKL_TRACE("Created FrameContexts with {} command pools each", NumThreads);
 }
 
-void VulkanApp::RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32_t SwapchainImageIndex)
+void VulkanApp::DestroyFrameContexts()
 {
+    uint32_t NumCommandBuffers = 0;
+    for (FrameContext &Frame : m_FrameContexts)
+    {
+        NumCommandBuffers += Frame.GetNumAllocatedCommandBuffers();
+        Frame.Shutdown();
+    }
+    VKL_TRACE("FrameContexts destroyed, {} VkCommandBuffers were allocated in total", NumCommandBuffers);
+}
+
+void VulkanApp::CreateCommandBufferCache()
+{
+    if (!m_Settings.bCacheCommandBuffers)
+    {
+        return;
+    }
+    m_CommandBufferCache.Init(
+        m_VkDevice,
+        m_QueueFamilyIndices.GraphicsFamily.value(),
+        &m_DeletionQueue,
+        &m_GraphicsTimeline,
+        m_pVkAllocator
+    );
+    m_CommandBufferCache.Resize(static_cast<uint32_t>(m_SwapchainImages.size()), m_NumFramesInFlight);
+    VKL_TRACE("Created CommandBufferCache");
+}
+
+void VulkanApp::DestroyCommandBufferCache()
+{
+    if (!m_Settings.bCacheCommandBuffers)
+    {
+        return;
+    }
+    m_CommandBufferCache.Shutdown();
+    VKL_TRACE("CommandBufferCache destroyed");
+}
+
+void VulkanApp::RecordCommandBuffer(
+    VkCommandBuffer                CommandBuffer,
+    uint32_t                       SwapchainImageIndex,
+    std::vector<DrawPacket> const &Packets,
+    uint32_t                       NumWorkers
+)
+{
+    // Indirect path records a handful of commands, nothing to split between workers
+    bool const bUseWorkers = NumWorkers > 0 && m_RecordingWorkers && !m_Settings.bIndirectDraws;
+
     VkCommandBufferBeginInfo CommandBufferBeginInfo{};
     CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -1938,71 +2765,511 @@ void VulkanApp::RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32_t Swap
     RenderPassBeginInfo.clearValueCount = 1;
     RenderPassBeginInfo.pClearValues    = &ClearColor;
 
-    vkCmdBeginRenderPass(CommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-    {
-        vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_VkPipeline);
-
-        // Viewport and Scissor are dynamic - specify them here
-        VkViewport Viewport{};
-        Viewport.x        = 0.0f;
-        Viewport.y        = 0.0f;
-        Viewport.width    = static_cast<float>(m_SwapchainExtent.width);
-        Viewport.height   = static_cast<float>(m_SwapchainExtent.height);
-        Viewport.minDepth = 0.0f;
-        Viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(CommandBuffer, 0, 1, &Viewport);
-
-        VkRect2D Scissor{};
-        Scissor.offset = {0, 0};
-        Scissor.extent = m_SwapchainExtent;
-        vkCmdSetScissor(CommandBuffer, 0, 1, &Scissor);
-
-        VkBuffer     Buffers[] = {m_VkVertexBuffer};
-        VkDeviceSize Offsets[] = {0};
-        vkCmdBindVertexBuffers(CommandBuffer, 0, 1, Buffers, Offsets);
-
-        vkCmdBindDescriptorSets(
-            CommandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_VkPipelineLayout,
-            0,
-            1,
-            &m_VkDescriptorSets[m_CurrentFrame],
-            0,
-            nullptr
+    // Subpass can either be recorded inline or consist only of secondary command buffers
+    VkSubpassContents const SubpassContents =
+        bUseWorkers ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+
+    vkCmdBeginRenderPass(CommandBuffer, &RenderPassBeginInfo, SubpassContents);
+    {
+        if (m_Settings.bIndirectDraws)
+        {
+            m_CommandRecorderStats += RecordIndirectDraws(CommandBuffer, Packets);
+        }
+        else if (bUseWorkers)
+        {
+            m_CommandRecorderStats +=
+                RecordDrawsOnWorkers(CommandBuffer, SwapchainImageIndex, Packets, NumWorkers);
+        }
+        else
+        {
+            m_CommandRecorderStats += RecordDraws(CommandBuffer, Packets.data(), Packets.size());
+        }
+    }
+    vkCmdEndRenderPass(CommandBuffer);
+
+    if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to End VkCommandBuffer!");
+        exit(1);
+    }
+}
+
+void VulkanApp::BindDrawState(CommandRecorder &Recorder, uint32_t PipelineId) const
+{
+    bool const bInstanced = PipelineId == s_InstancedPipelineId;
+    Recorder.BindPipeline(bInstanced ? m_VkInstancedPipeline : m_VkPipeline);
+
+    // Viewport and Scissor are dynamic - specify them here
+    VkViewport Viewport{};
+    Viewport.x        = 0.0f;
+    Viewport.y        = 0.0f;
+    Viewport.width    = static_cast<float>(m_SwapchainExtent.width);
+    Viewport.height   = static_cast<float>(m_SwapchainExtent.height);
+    Viewport.minDepth = 0.0f;
+    Viewport.maxDepth = 1.0f;
+    Recorder.SetViewport(Viewport);
+
+    VkRect2D Scissor{};
+    Scissor.offset = {0, 0};
+    Scissor.extent = m_SwapchainExtent;
+    Recorder.SetScissor(Scissor);
+
+    m_GeometryBuffer.Bind(Recorder);
+    if (bInstanced)
+    {
+        Recorder.BindVertexBuffer(InstanceData::s_Binding, m_VkInstanceBuffer);
+    }
+    // In order of bindings
+    uint32_t const DynamicOffsets[] = {m_MatricesUBOOffset, m_ObjectsUBOOffset};
+    Recorder.BindDescriptorSet(m_VkPipelineLayout, 0, m_VkDescriptorSets[m_CurrentFrame], 2, DynamicOffsets);
+}
+
+void VulkanApp::PushObjectConstants(CommandRecorder &Recorder, uint32_t ObjectIndex) const
+{
+    SceneObject const &Object = m_SceneObjects[ObjectIndex];
+
+    ObjectPushConstants PushConstants{};
+    PushConstants.ObjectIndex   = ObjectIndex;
+    PushConstants.MaterialIndex = Object.MaterialIndex;
+
+    Recorder.PushConstants(
+        m_VkPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstants), &PushConstants
+    );
+}
+
+CommandRecorderStats VulkanApp::RecordDraws(
+    VkCommandBuffer CommandBuffer, DrawPacket const *Packets, size_t NumPackets
+)
+{
+    CommandRecorder Recorder(CommandBuffer);
+    for (size_t i = 0; i < NumPackets; ++i)
+    {
+        DrawPacket const &Packet = Packets[i];
+
+        BindDrawState(Recorder, RenderQueue::GetPipelineId(Packet.SortKey));
+        PushObjectConstants(Recorder, Packet.ObjectIndex);
+        m_GeometryBuffer.Draw(Recorder, Packet.Mesh, Packet.InstanceCount, Packet.FirstInstance);
+    }
+    return Recorder.GetStats();
+}
+
+void VulkanApp::FillIndirectDraws(std::vector<DrawPacket> const &Packets)
+{
+    if (!m_Settings.bIndirectDraws)
+    {
+        return;
+    }
+
+    IndirectDrawBuffer &IndirectBuffer = m_IndirectDrawBuffers[m_CurrentFrame];
+
+    // Cached command buffers of other swapchain images could still point at the old buffer
+    if (IndirectBuffer.Reserve(static_cast<uint32_t>(Packets.size())))
+    {
+        m_CommandBufferCache.Invalidate();
+    }
+
+    VkDrawIndexedIndirectCommand *Commands   = IndirectBuffer.GetCommands();
+    uint32_t                     *DrawCounts = IndirectBuffer.GetDrawCounts();
+
+    uint32_t const NumPackets = static_cast<uint32_t>(Packets.size());
+    uint32_t       NumBatches = 0;
+    for (uint32_t BatchStart = 0; BatchStart < NumPackets;)
+    {
+        uint32_t const BatchEnd = GetIndirectBatchEnd(Packets, BatchStart);
+        for (uint32_t i = BatchStart; i < BatchEnd; ++i)
+        {
+            DrawPacket const &Packet = Packets[i];
+            Commands[i] =
+                GeometryBuffer::GetIndirectCommand(Packet.Mesh, Packet.InstanceCount, Packet.FirstInstance);
+        }
+
+        // Count is read by GPU, so later it can be written by culling instead of CPU
+        if (m_bDrawIndirectCountEnabled)
+        {
+            DrawCounts[NumBatches] = BatchEnd - BatchStart;
+        }
+
+        NumBatches++;
+        BatchStart = BatchEnd;
+    }
+}
+
+CommandRecorderStats VulkanApp::RecordIndirectDraws(
+    VkCommandBuffer CommandBuffer, std::vector<DrawPacket> const &Packets
+)
+{
+    IndirectDrawBuffer const &IndirectBuffer = m_IndirectDrawBuffers[m_CurrentFrame];
+
+    VkBuffer const Buffer = IndirectBuffer.GetBuffer();
+    uint32_t const Stride = static_cast<uint32_t>(IndirectDrawBuffer::s_CommandStride);
+
+    CommandRecorder Recorder(CommandBuffer);
+
+    uint32_t const NumPackets = static_cast<uint32_t>(Packets.size());
+    uint32_t       NumBatches = 0;
+    for (uint32_t BatchStart = 0; BatchStart < NumPackets;)
+    {
+        uint32_t const BatchEnd  = GetIndirectBatchEnd(Packets, BatchStart);
+        uint32_t const BatchSize = BatchEnd - BatchStart;
+
+        BindDrawState(Recorder, RenderQueue::GetPipelineId(Packets[BatchStart].SortKey));
+        PushObjectConstants(Recorder, Packets[BatchStart].ObjectIndex);
+
+        if (m_bDrawIndirectCountEnabled)
+        {
+            Recorder.DrawIndexedIndirectCount(
+                Buffer,
+                IndirectBuffer.GetCommandOffset(BatchStart),
+                Buffer,
+                IndirectBuffer.GetDrawCountOffset(NumBatches),
+                BatchSize,
+                Stride
+            );
+        }
+        else
+        {
+            Recorder.DrawIndexedIndirect(
+                Buffer, IndirectBuffer.GetCommandOffset(BatchStart), BatchSize, Stride
+            );
+        }
+
+        NumBatches++;
+        BatchStart = BatchEnd;
+    }
+    return Recorder.GetStats();
+}
+
+uint32_t VulkanApp::GetIndirectBatchEnd(std::vector<DrawPacket> const &Packets, uint32_t BatchStart) const
+{
+    // Sorted packets with equal state are next to each other.
+    // Push constants can't change inside of one indirect draw, so batch is limited to one object
+    uint32_t const NumPackets  = static_cast<uint32_t>(Packets.size());
+    uint64_t const StateKey    = RenderQueue::GetStateKey(Packets[BatchStart].SortKey);
+    uint32_t const ObjectIndex = Packets[BatchStart].ObjectIndex;
+    uint32_t       BatchEnd    = BatchStart;
+    while (BatchEnd < NumPackets && BatchEnd - BatchStart < m_MaxDrawIndirectCount &&
+           RenderQueue::GetStateKey(Packets[BatchEnd].SortKey) == StateKey &&
+           Packets[BatchEnd].ObjectIndex == ObjectIndex)
+    {
+        ++BatchEnd;
+    }
+    return BatchEnd;
+}
+
+CommandRecorderStats VulkanApp::RecordDrawsOnWorkers(
+    VkCommandBuffer                CommandBuffer,
+    uint32_t                       SwapchainImageIndex,
+    std::vector<DrawPacket> const &Packets,
+    uint32_t                       NumWorkers
+)
+{
+    NumWorkers = std::min(NumWorkers, m_RecordingWorkers->GetNumWorkers());
+
+    size_t const NumPacketsPerWorker = (Packets.size() + NumWorkers - 1) / NumWorkers;
+
+    // Secondary buffers don't inherit any state from primary, each of them sets everything up
+    FrameContext &Frame = m_FrameContexts[m_CurrentFrame];
+
+    std::vector<VkCommandBuffer>      SecondaryCommandBuffers(NumWorkers);
+    std::vector<CommandRecorderStats> WorkerStats(NumWorkers);
+    m_RecordingWorkers->Run(
+        NumWorkers,
+        [&](uint32_t Worker)
+        {
+            // Thread 0 of FrameContext is the main thread
+            VkCommandBuffer const WorkerCommandBuffer =
+                Frame.AcquireCommandBuffer(Worker + 1, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            SecondaryCommandBuffers[Worker] = WorkerCommandBuffer;
+
+            VkCommandBufferInheritanceInfo InheritanceInfo{};
+            InheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+            InheritanceInfo.renderPass  = m_VkRenderPass;
+            InheritanceInfo.subpass     = 0;
+            InheritanceInfo.framebuffer = m_VkFramebuffers[SwapchainImageIndex];
+
+            VkCommandBufferBeginInfo BeginInfo{};
+            BeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            BeginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+                              VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            BeginInfo.pInheritanceInfo = &InheritanceInfo;
+
+            if (vkBeginCommandBuffer(WorkerCommandBuffer, &BeginInfo) != VK_SUCCESS)
+            {
+                VKL_CRITICAL("Failed to Begin secondary VkCommandBuffer!");
+                exit(1);
+            }
+
+            // Sorted order is kept, every worker gets a contiguous run of packets
+            size_t const First  = std::min(Packets.size(), Worker * NumPacketsPerWorker);
+            size_t const Count  = std::min(Packets.size() - First, NumPacketsPerWorker);
+            WorkerStats[Worker] = RecordDraws(WorkerCommandBuffer, Packets.data() + First, Count);
+
+            if (vkEndCommandBuffer(WorkerCommandBuffer) != VK_SUCCESS)
+            {
+                VKL_CRITICAL("Failed to End secondary VkCommandBuffer!");
+                exit(1);
+            }
+        }
+    );
+
+    vkCmdExecuteCommands(
+        CommandBuffer, static_cast<uint32_t>(SecondaryCommandBuffers.size()), SecondaryCommandBuffers.data()
+    );
+
+    CommandRecorderStats Stats;
+    for (CommandRecorderStats const &Worker : WorkerStats)
+    {
+        Stats += Worker;
+    }
+    return Stats;
+}
+
+void VulkanApp::RunRecordingBenchmark()
+{
+    constexpr uint32_t NumDraws      = 50000;
+    constexpr uint32_t NumIterations = 20;
+
+    DrawPacket Packet{};
+    Packet.Mesh        = m_CubeMesh;
+    Packet.ObjectIndex = m_CubeObjectIndex;
+
+    std::vector<DrawPacket> const Packets(NumDraws, Packet);
+
+    // Nothing is in flight yet, so frame 0 buffers can be recorded freely, they are never submitted
+    FrameContext &Frame = m_FrameContexts[m_CurrentFrame];
+
+    auto const MeasureRecording = [&](uint32_t NumWorkers)
+    {
+        auto const StartTime = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < NumIterations; ++i)
+        {
+            Frame.Reset();
+            FillIndirectDraws(Packets);
+            RecordCommandBuffer(
+                Frame.AcquireCommandBuffer(0, VK_COMMAND_BUFFER_LEVEL_PRIMARY), 0, Packets, NumWorkers
+            );
+        }
+        auto const  EndTime = std::chrono::high_resolution_clock::now();
+        float const ElapsedMs =
+            std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(EndTime - StartTime).count();
+
+        VKL_INFO(
+            "Recording benchmark: {} draws, {} worker threads(0 - primary only) - {:.3f} ms per frame",
+            NumDraws,
+            NumWorkers,
+            ElapsedMs / NumIterations
         );
+    };
+
+    MeasureRecording(0);
+    if (m_Settings.bIndirectDraws)
+    {
+        // Indirect path ignores workers
+        VKL_INFO("Recording benchmark used indirect draws");
+    }
+    else
+    {
+        for (uint32_t NumWorkers = 1; NumWorkers < m_RecordingWorkers->GetNumWorkers(); NumWorkers *= 2)
+        {
+            MeasureRecording(NumWorkers);
+        }
+        MeasureRecording(m_RecordingWorkers->GetNumWorkers());
+    }
+
+    Frame.Reset();
+
+    // Benchmark recordings were never submitted, don't count them as frames
+    m_CommandRecorderStats = CommandRecorderStats{};
+}
+
+void VulkanApp::BuildRenderQueue()
+{
+    glm::vec3 const CameraPosition = m_Camera.GetPosition();
+    glm::vec3 const CameraForward  = m_Camera.GetForward();
+    float const     NearClip       = m_Camera.GetNearClip();
+    float const     FarClip        = m_Camera.GetFarClip();
+
+    m_RenderQueue.Clear();
+    for (uint32_t ObjectIndex = 0; ObjectIndex < m_SceneObjects.size(); ++ObjectIndex)
+    {
+        SceneObject const &Object = m_SceneObjects[ObjectIndex];
+        MeshHandle const  &Mesh   = Object.Mesh;
 
-        vkCmdBindIndexBuffer(CommandBuffer, m_VkIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+        glm::vec3 const Position  = glm::vec3(Object.Model[3]);
+        float const     ViewDepth = glm::dot(Position - CameraPosition, CameraForward);
+        float const     Depth     = (ViewDepth - NearClip) / (FarClip - NearClip);
 
-        vkCmdDrawIndexed(CommandBuffer, static_cast<uint32_t>(m_Indices.size()), 1, 0, 0, 0);
+        // One descriptor set per frame - its id is always 0
+        if (Object.InstanceCount > 0)
+        {
+            uint64_t const SortKey =
+                RenderQueue::MakeSortKey(DrawPass::Opaque, s_InstancedPipelineId, 0, Mesh.Id, Depth);
+            m_RenderQueue.Push(SortKey, ObjectIndex, Mesh, 0, Object.InstanceCount);
+        }
+        else
+        {
+            uint64_t const SortKey =
+                RenderQueue::MakeSortKey(DrawPass::Opaque, s_DefaultPipelineId, 0, Mesh.Id, Depth);
+            m_RenderQueue.Push(SortKey, ObjectIndex, Mesh);
+        }
     }
-    vkCmdEndRenderPass(CommandBuffer);
+    m_RenderQueue.Sort();
+}
+
+void VulkanApp::UpdateRenderQueue()
+{
+    if (!m_bSceneDirty)
+    {
+        return;
+    }
+    m_bSceneDirty = false;
+
+    BuildRenderQueue();
+    if (!RenderQueue::HasSameDraws(m_RenderQueue.GetPackets(), m_RecordedPackets))
+    {
+        m_RecordedPackets = m_RenderQueue.GetPackets();
+        m_CommandBufferCache.Invalidate();
+    }
+}
+
+void VulkanApp::RunSortingBenchmark()
+{
+    constexpr uint32_t NumPackets    = 100000;
+    constexpr uint32_t NumIterations = 100;
+
+    // Few pipelines and sets, many meshes and depths - roughly what a scene would produce
+    std::mt19937                            Random(42);
+    std::uniform_int_distribution<uint32_t> PassDistribution(0, 1);
+    std::uniform_int_distribution<uint32_t> PipelineDistribution(0, 7);
+    std::uniform_int_distribution<uint32_t> DescriptorSetDistribution(0, 31);
+    std::uniform_int_distribution<uint32_t> MeshDistribution(0, 1023);
+    std::uniform_real_distribution<float>   DepthDistribution(0.0f, 1.0f);
+
+    std::vector<uint64_t> SortKeys(NumPackets);
+    for (uint64_t &SortKey : SortKeys)
+    {
+        SortKey = RenderQueue::MakeSortKey(
+            static_cast<DrawPass>(PassDistribution(Random)),
+            PipelineDistribution(Random),
+            DescriptorSetDistribution(Random),
+            MeshDistribution(Random),
+            DepthDistribution(Random)
+        );
+    }
+
+    RenderQueue Queue;
+    Queue.Reserve(NumPackets);
+
+    float ElapsedMs = 0.0f;
+    for (uint32_t i = 0; i < NumIterations; ++i)
+    {
+        Queue.Clear();
+        for (uint64_t const SortKey : SortKeys)
+        {
+            Queue.Push(SortKey, m_CubeObjectIndex, m_CubeMesh);
+        }
+
+        auto const StartTime = std::chrono::high_resolution_clock::now();
+        Queue.Sort();
+        auto const EndTime = std::chrono::high_resolution_clock::now();
+        ElapsedMs +=
+            std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(EndTime - StartTime).count();
+    }
+
+    auto const ByKey = [](DrawPacket const &Lhs, DrawPacket const &Rhs) { return Lhs.SortKey < Rhs.SortKey; };
+    if (!std::is_sorted(Queue.GetPackets().begin(), Queue.GetPackets().end(), ByKey))
+    {
+        VKL_CRITICAL("RenderQueue sorted packets out of order!");
+        exit(1);
+    }
+
+    VKL_INFO(
+        "Sorting benchmark: {} draw packets - {:.3f} ms per sort", NumPackets, ElapsedMs / NumIterations
+    );
+}
+
+VkCommandBuffer VulkanApp::RecordOwnershipAcquires()
+{
+    VkCommandBuffer const CommandBuffer =
+        m_FrameContexts[m_CurrentFrame].AcquireCommandBuffer(0, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+    VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+    CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(CommandBuffer, &CommandBufferBeginInfo) != VK_SUCCESS)
+    {
+        VKL_CRITICAL("Failed to Begin VkCommandBuffer!");
+        exit(1);
+    }
+
+    // Buffers uploaded on transfer queue since last frame
+    m_UploadBatch.RecordAcquireBarriers(CommandBuffer, m_FramesOwnershipAcquires[m_CurrentFrame]);
 
     if (vkEndCommandBuffer(CommandBuffer) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to End VkCommandBuffer!");
         exit(1);
     }
+    return CommandBuffer;
 }
 
-void VulkanApp::SubmitCommandBuffer(VkCommandBuffer CommandBuffer)
+void VulkanApp::SubmitCommandBuffers(VkCommandBuffer const *CommandBuffers, uint32_t NumCommandBuffers)
 {
-    VkSemaphore          WaitSemaphores[] = {m_ImageAvailableSemaphores[m_CurrentFrame]};
-    VkPipelineStageFlags WaitStages[]     = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+    std::vector<VkSemaphore>          WaitSemaphores;
+    std::vector<VkPipelineStageFlags> WaitStages;
+    std::vector<uint64_t>             WaitValues;
+
+    // Offscreen image of headless frame is free once the frame's previous submission is finished
+    if (!m_Settings.bHeadless)
+    {
+        WaitSemaphores.push_back(m_ImageAvailableSemaphores[m_CurrentFrame]);
+        WaitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        WaitValues.push_back(0); // Ignored for binary semaphores
+    }
+
+    // Acquire barriers can't run before uploads are released on transfer queue
+    uint64_t UploadValue = 0;
+    for (QueueOwnershipAcquire const &OwnershipAcquire : m_FramesOwnershipAcquires[m_CurrentFrame])
+    {
+        UploadValue = std::max(UploadValue, OwnershipAcquire.UploadValue);
+    }
+    if (UploadValue > 0)
+    {
+        WaitSemaphores.push_back(m_TransferTimeline.Get());
+        WaitStages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+        WaitValues.push_back(UploadValue);
+    }
 
-    VkSemaphore SignalSemaphores[] = {m_RenderFinishedSemaphores[m_CurrentFrame]};
+    // Frame is finished once graphics timeline reaches its value
+    uint64_t const FrameTimelineValue = m_GraphicsTimeline.ReserveNextValue();
+    m_FrameContexts[m_CurrentFrame].SetTimelineValue(FrameTimelineValue);
+
+    // Render finished semaphore is waited for by present only
+    VkSemaphore SignalSemaphores[] = {m_GraphicsTimeline.Get(), m_RenderFinishedSemaphores[m_CurrentFrame]};
+    uint64_t    SignalValues[]     = {FrameTimelineValue, 0};
+
+    uint32_t const NumSignalSemaphores = m_Settings.bHeadless ? 1 : 2;
+
+    VkTimelineSemaphoreSubmitInfo TimelineSubmitInfo{};
+    TimelineSubmitInfo.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    TimelineSubmitInfo.waitSemaphoreValueCount   = static_cast<uint32_t>(WaitValues.size());
+    TimelineSubmitInfo.pWaitSemaphoreValues      = WaitValues.data();
+    TimelineSubmitInfo.signalSemaphoreValueCount = NumSignalSemaphores;
+    TimelineSubmitInfo.pSignalSemaphoreValues    = SignalValues;
 
     VkSubmitInfo SubmitInfo{};
     SubmitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    SubmitInfo.waitSemaphoreCount   = 1;
-    SubmitInfo.pWaitSemaphores      = WaitSemaphores;
-    SubmitInfo.pWaitDstStageMask    = WaitStages;
-    SubmitInfo.commandBufferCount   = 1;
-    SubmitInfo.pCommandBuffers      = &CommandBuffer;
-    SubmitInfo.signalSemaphoreCount = 1;
+    SubmitInfo.pNext                = &TimelineSubmitInfo;
+    SubmitInfo.waitSemaphoreCount   = static_cast<uint32_t>(WaitSemaphores.size());
+    SubmitInfo.pWaitSemaphores      = WaitSemaphores.data();
+    SubmitInfo.pWaitDstStageMask    = WaitStages.data();
+    SubmitInfo.commandBufferCount   = NumCommandBuffers;
+    SubmitInfo.pCommandBuffers      = CommandBuffers;
+    SubmitInfo.signalSemaphoreCount = NumSignalSemaphores;
     SubmitInfo.pSignalSemaphores    = SignalSemaphores;
 
-    if (vkQueueSubmit(m_VkGraphicsQueue, 1, &SubmitInfo, m_InFlightFences[m_CurrentFrame]) != VK_SUCCESS)
+    if (vkQueueSubmit(m_VkGraphicsQueue, 1, &SubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
     {
         VKL_CRITICAL("Failed to submit draw commands buffer!");
         exit(1);
@@ -2029,7 +3296,9 @@ VkResult VulkanApp::PresentResult(uint32_t SwapchainImageIndex)
 
 void VulkanApp::CreateSyncObjects()
 {
-    for (uint32_t i = 0; i < s_FramesInFlight; ++i)
+    m_ImageAvailableSemaphores.resize(m_NumFramesInFlight);
+    m_RenderFinishedSemaphores.resize(m_NumFramesInFlight);
+    for (uint32_t i = 0; i < m_NumFramesInFlight; ++i)
     {
         VkSemaphoreCreateInfo ImageAvailableSemaphoreInfo{};
         ImageAvailableSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -2037,17 +3306,12 @@ void VulkanApp::CreateSyncObjects()
         VkSemaphoreCreateInfo RenderFinishedSemaphoreInfo{};
         RenderFinishedSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        VkFenceCreateInfo InFlightFenceInfo{};
-        InFlightFenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        InFlightFenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
         if (vkCreateSemaphore(
-                m_VkDevice, &ImageAvailableSemaphoreInfo, nullptr, &m_ImageAvailableSemaphores[i]
+                m_VkDevice, &ImageAvailableSemaphoreInfo, m_pVkAllocator, &m_ImageAvailableSemaphores[i]
             ) != VK_SUCCESS ||
             vkCreateSemaphore(
-                m_VkDevice, &RenderFinishedSemaphoreInfo, nullptr, &m_RenderFinishedSemaphores[i]
-            ) != VK_SUCCESS ||
-            vkCreateFence(m_VkDevice, &InFlightFenceInfo, nullptr, &m_InFlightFences[i]) != VK_SUCCESS)
+                m_VkDevice, &RenderFinishedSemaphoreInfo, m_pVkAllocator, &m_RenderFinishedSemaphores[i]
+            ) != VK_SUCCESS)
         {
             VKL_CRITICAL("Failed to create Syncronization objects!");
             exit(1);
@@ -2058,11 +3322,29 @@ void VulkanApp::CreateSyncObjects()
 
 void VulkanApp::DestroySyncObjects()
 {
-    for (uint32_t i = 0; i < s_FramesInFlight; ++i)
+    for (uint32_t i = 0; i < m_NumFramesInFlight; ++i)
     {
-        vkDestroySemaphore(m_VkDevice, m_ImageAvailableSemaphores[i], nullptr);
-        vkDestroySemaphore(m_VkDevice, m_RenderFinishedSemaphores[i], nullptr);
-        vkDestroyFence(m_VkDevice, m_InFlightFences[i], nullptr);
+        vkDestroySemaphore(m_VkDevice, m_ImageAvailableSemaphores[i], m_pVkAllocator);
+        vkDestroySemaphore(m_VkDevice, m_RenderFinishedSemaphores[i], m_pVkAllocator);
     }
     VKL_TRACE("Syncronization objects destroyed");
 }
+
+void VulkanApp::CreateTimelineSemaphores()
+{
+    m_GraphicsTimeline.Create(m_VkDevice, m_pVkAllocator);
+    m_TransferTimeline.Create(m_VkDevice, m_pVkAllocator);
+    VKL_TRACE("Created timeline VkSemaphores successfully");
+}
+
+void VulkanApp::DestroyTimelineSemaphores()
+{
+    m_GraphicsTimeline.Destroy();
+    m_TransferTimeline.Destroy();
+    VKL_TRACE("Timeline VkSemaphores destroyed");
+}
+
+void VulkanApp::RetireResource(std::function<void()> &&Deleter)
+{
+    m_DeletionQueue.Push(m_GraphicsTimeline.GetLastSubmittedValue(), std::move(Deleter));
+}
@@ -1,17 +1,42 @@
 #ifndef VULKANLEARNING_VULKANAPP
 #define VULKANLEARNING_VULKANAPP
 
+#include "AppSettings.h"
 #include "Camera.h"
+#include "CommandRecorder.h"
+#include "CommandBufferCache.h"
+#include "DeletionQueue.h"
+#include "DeviceMemoryAllocator.h"
+#include "FrameContext.h"
+#include "FrameLatencyTracker.h"
+#include "GeometryBuffer.h"
+#include "HostAllocationTracker.h"
+#include "IndirectDrawBuffer.h"
+#include "InstanceData.h"
 #include "Log.h"
+#include "MemoryBudgetTracker.h"
+#include "MemoryPolicy.h"
+#include "ObjectPushConstants.h"
+#include "PipelineCache.h"
 #include "QueueFamilyIndices.h"
+#include "RenderQueue.h"
+#include "ResizeController.h"
+#include "SceneObject.h"
+#include "StagingRing.h"
 #include "SwapchainSupportDetails.h"
+#include "TimelineSemaphore.h"
+#include "UniformArena.h"
+#include "UploadBatch.h"
 #include "Vertex.h"
 #include "Window.h"
+#include "WorkerPool.h"
 
 #include <array>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -22,7 +47,7 @@
 class VulkanApp
 {
 public:
-    VulkanApp(int WindowWidth, int WindowHeight);
+    VulkanApp(int WindowWidth, int WindowHeight, AppSettings const &Settings = {});
 
     void Run();
 
@@ -32,17 +57,39 @@ private:
     void CleanUp();
 
     void UpdateCamera(float ElapsedTime);
+    void ProcessRuntimeControls();
+    void UpdateSceneObjects(float ElapsedTime);
+
+    // True only on the first frame key is held down
+    bool IsKeyPressedOnce(int Key);
 
     void DrawFrame();
 
 private:
-    Window m_Window;
+    static constexpr char const *s_ApplicationName = "3-UniformBuffer";
+
+    // Headless mode has fixed time step, so every run renders the same frames
+    static constexpr float s_HeadlessFrameTime = 1.0f / 60.0f;
+
+    // Minimized window is checked for restore or close that often, seconds
+    static constexpr double s_MinimizedWaitTimeout = 0.1;
+
+    AppSettings             m_Settings;
+    std::unique_ptr<Window> m_Window; // Not created in headless mode
+    VkExtent2D              m_RequestedExtent{};
 
-    uint32_t                  m_CurrentFrame   = 0;
-    static constexpr uint32_t s_FramesInFlight = 2;
+    float m_SceneTime = 0.0f; // Seconds of animation
 
-    // VK_ERROR_OUT_OF_DATE_KHR not guaranteed
-    bool m_bWindowResizeHappened = false;
+    // Size of every per-frame container below, fixed for the whole run
+    uint32_t m_NumFramesInFlight = 0;
+    uint32_t m_CurrentFrame      = 0;
+
+    // Pipeline ids of draw packet sort keys
+    static constexpr uint32_t s_DefaultPipelineId   = 0;
+    static constexpr uint32_t s_InstancedPipelineId = 1;
+
+    // VK_ERROR_OUT_OF_DATE_KHR not guaranteed, size events of the window decide when swapchain is rebuilt
+    ResizeController m_ResizeController;
 
     static void OnWindowResized(GLFWwindow *Window, int NewWidth, int NewHeight);
 
@@ -68,6 +115,8 @@ private:
     std::vector<VkPhysicalDevice>      GetPhysicalDevices() const;
     VkPhysicalDeviceProperties         GetPhysicalDeviceProperties(VkPhysicalDevice PhysicalDevice) const;
     VkPhysicalDeviceFeatures           GetPhysicalDeviceFeatures(VkPhysicalDevice PhysicalDevice) const;
+    VkPhysicalDeviceVulkan12Features   GetPhysicalDeviceVulkan12Features(VkPhysicalDevice PhysicalDevice
+    ) const;
     std::vector<VkExtensionProperties> GetPhysicalDeviceSupportedExtensions(VkPhysicalDevice PhysicalDevice
     ) const;
 
@@ -76,6 +125,8 @@ private:
 
     bool     IsPhysicalDeviceSuitable(VkPhysicalDevice PhysicalDevice) const;
     bool     IsPhysicalDeviceExtensionSupportComplete(VkPhysicalDevice PhysicalDevice) const;
+    bool     IsPhysicalDeviceExtensionSupported(VkPhysicalDevice PhysicalDevice, char const *Extension) const;
+    bool     IsPhysicalDeviceTimelineSemaphoreSupported(VkPhysicalDevice PhysicalDevice) const;
     uint32_t GetPhysicalDeviceSuitability(VkPhysicalDevice PhysicalDevice) const;
     // !VK_PHYSICAL_DEVICE
     //=========================================================================================================
@@ -102,6 +153,11 @@ private:
         VkQueueFamilyProperties const &QueueFamilyProperties,
         uint32_t                       QueueFamilyIndex
     ) const;
+    uint32_t GetPhysicalDeviceTransferQueueFamilySuitability(
+        VkPhysicalDevice               PhysicalDevice,
+        VkQueueFamilyProperties const &QueueFamilyProperties,
+        uint32_t                       QueueFamilyIndex
+    ) const;
     // !VK_QUEUE_FAMILY
     //=========================================================================================================
     // VK_DEVICE
@@ -139,16 +195,28 @@ private:
     VkExtent2D         SelectSwapchainExtent(VkSurfaceCapabilitiesKHR const &Capabilities) const;
     VkSurfaceFormatKHR SelectSwapchainSurfaceFormat(std::vector<VkSurfaceFormatKHR> const &Formats) const;
     VkPresentModeKHR   SelectSwapchainPresentationMode(std::vector<VkPresentModeKHR> const &Modes) const;
-    uint32_t           SelectSwapchainImagesCount(VkSurfaceCapabilitiesKHR const &Capabilities) const;
+    uint32_t           SelectSwapchainImagesCount(
+        VkSurfaceCapabilitiesKHR const &Capabilities, VkPresentModeKHR PresentMode
+    ) const;
 
-    void CreateSwapchain();
+    // OldSwapchain - swapchain being replaced, presentation engine may reuse its resources
+    void CreateSwapchain(VkSwapchainKHR OldSwapchain = VK_NULL_HANDLE);
     void DestroySwapchain();
 
+    // Frames in flight keep rendering, old swapchain with its views and framebuffers is retired
     void RecreateSwapchain();
+    void RetireSwapchain(VkSwapchainKHR OldSwapchain);
 
     void RetrieveSwapchainImages();
     // !VK_KHR_SWAPCHAIN
     //=========================================================================================================
+    // HEADLESS
+    // Take place of swapchain images, one per frame in flight - image is free once its frame is finished.
+    // Rendered with the same render pass, left in TRANSFER_SRC_OPTIMAL layout for readback
+    void CreateOffscreenImages();
+    void DestroyOffscreenImages();
+    // !HEADLESS
+    //=========================================================================================================
     // VK_IMAGE_VIEW
     void CreateSwapchainImagesViews();
     void DestroySwapchainImagesViews();
@@ -165,7 +233,7 @@ private:
     VkPipelineShaderStageCreateInfo GetFragmentShaderStageInfo(VkShaderModule ShaderModule) const;
 
     // Fixed Stages
-    VkPipelineVertexInputStateCreateInfo   GetVertexInputStateInfo();
+    VkPipelineVertexInputStateCreateInfo   GetVertexInputStateInfo(bool bInstanced);
     VkPipelineInputAssemblyStateCreateInfo GetInputAssemblyStateInfo() const;
 
     // Static Viewport and Scissor
@@ -200,8 +268,17 @@ private:
     void CreatePipelineLayout();
     void DestroyPipelineLayout();
 
-    void CreatePipeline();
+    // Loaded from disk, saved back on destruction
+    void CreatePipelineCache();
+    void DestroyPipelineCache();
+
+    // Instanced one only with --instances
+    void       CreatePipeline();
+    VkPipeline CreateGraphicsPipeline(std::filesystem::path const &VertexShaderPath, bool bInstanced);
     void DestroyPipeline();
+
+    // Shaders are read from disk again, old pipeline is retired without device stall
+    void RecreatePipeline();
     // !VK_PIPELINE
     //=========================================================================================================
     // VK_SPIRV_SHADER
@@ -217,31 +294,53 @@ private:
     // !VK_FRAMEBUFFER
     //=========================================================================================================
     // VK_BUFFER
+    void CreateDeviceMemoryAllocator();
+    void DestroyDeviceMemoryAllocator();
+
     void CreateBuffer(
-        VkBuffer             &Buffer,
-        VkDeviceMemory       &BufferMemory,
-        VkBufferUsageFlags    Usage,
-        VkDeviceSize          Size,
-        VkMemoryPropertyFlags Properties
+        VkBuffer               &Buffer,
+        DeviceMemoryAllocation &BufferAllocation,
+        VkBufferUsageFlags      Usage,
+        VkDeviceSize            Size,
+        MemoryUsage             MemoryIntent
     );
-    void DestroyBuffer(VkBuffer &Buffer, VkDeviceMemory &BufferMemory);
+    void DestroyBuffer(VkBuffer &Buffer, DeviceMemoryAllocation &BufferAllocation);
+
+    // Destroyed once frames that could use it are finished, buffer must not have uploads in flight
+    void RetireBuffer(VkBuffer &Buffer, DeviceMemoryAllocation &BufferAllocation);
+
+    // Shared vertex/index buffers for all meshes
+    void CreateGeometryBuffer();
+    void DestroyGeometryBuffer();
+
+    void CreateCubeMesh();
 
-    void CreateVertexBuffer();
-    void DestroyVertexBuffer();
+    // Grid of cube transforms for --instances, uploaded once
+    void CreateInstanceBuffer();
+    void DestroyInstanceBuffer();
 
-    void CreateIndexBuffer();
-    void DestroyIndexBuffer();
+    // One persistently mapped staging buffer shared by all uploads
+    void CreateUploadBatch();
+    void DestroyUploadBatch();
 
-    void TransferBufferData(VkBuffer Source, VkBuffer Destination, VkDeviceSize Size);
+    // Loads many small meshes one by one and in a single batch
+    void RunUploadBenchmark();
+
+    // Only with --indirect-draws
+    void CreateIndirectDrawBuffers();
+    void DestroyIndirectDrawBuffers();
     // !VK_BUFFER
     //=========================================================================================================
     // VK_DESCRIPTOR
     void CreateDescriptorSetLayout();
     void DestroyDescriptorSetLayout();
 
-    void CreateUniformBuffers();
-    void DestroyUniformBuffers();
+    // One arena per frame in flight, sets bind them with dynamic offsets
+    void CreateUniformArenas();
+    void DestroyUniformArenas();
 
+    // Matrices of the camera and transforms of all objects in ObjectsUBO, both per frame. Draws push only
+    // indices into it. Resets arena of current frame - its previous submission has to be finished
     void UpdateUniformBuffers();
 
     void CreateDescriptorPool();
@@ -254,27 +353,113 @@ private:
     void CreateCommandPool();
     void DestroyCommandPool();
 
-    void AllocateCommandBuffers();
+    // Worker threads record secondary command buffers, each one from its own pool of FrameContext
+    void CreateRecordingWorkers();
+    void DestroyRecordingWorkers();
+
+    void CreateFrameContexts();
+    void DestroyFrameContexts();
+
+    // Only with --cache-command-buffers, scene command buffers are recorded again only after invalidation
+    void CreateCommandBufferCache();
+    void DestroyCommandBufferCache();
+
+    // With NumWorkers > 0 Packets are split between workers and executed as secondary command buffers
+    void RecordCommandBuffer(
+        VkCommandBuffer                CommandBuffer,
+        uint32_t                       SwapchainImageIndex,
+        std::vector<DrawPacket> const &Packets,
+        uint32_t                       NumWorkers
+    );
+    // Pipeline, dynamic state, geometry and descriptor set every draw needs
+    void BindDrawState(CommandRecorder &Recorder, uint32_t PipelineId) const;
+    void PushObjectConstants(CommandRecorder &Recorder, uint32_t ObjectIndex) const;
+
+    // Every draw asks for its full state, CommandRecorder drops what's already bound
+    CommandRecorderStats RecordDraws(
+        VkCommandBuffer CommandBuffer, DrawPacket const *Packets, size_t NumPackets
+    );
+    CommandRecorderStats RecordDrawsOnWorkers(
+        VkCommandBuffer                CommandBuffer,
+        uint32_t                       SwapchainImageIndex,
+        std::vector<DrawPacket> const &Packets,
+        uint32_t                       NumWorkers
+    );
+    // Packets are written into indirect buffer of the frame every frame, before recording and submit. Cached
+    // command buffers of all swapchain images share that buffer, none may rely on what it held when recorded
+    void FillIndirectDraws(std::vector<DrawPacket> const &Packets);
+
+    // One indirect draw per run of equal state, reads commands written by FillIndirectDraws from same Packets
+    CommandRecorderStats RecordIndirectDraws(
+        VkCommandBuffer CommandBuffer, std::vector<DrawPacket> const &Packets
+    );
+
+    // End of indirect draw starting at BatchStart - shared by filling and recording, so they always agree
+    uint32_t GetIndirectBatchEnd(std::vector<DrawPacket> const &Packets, uint32_t BatchStart) const;
 
-    void     RecordCommandBuffer(VkCommandBuffer CommandBuffer, uint32_t SwapchainImageIndex);
-    void     SubmitCommandBuffer(VkCommandBuffer CommandBuffer);
+    void RunRecordingBenchmark();
+
+    // m_SceneObjects into sorted packets, only when something is going to be recorded
+    void BuildRenderQueue();
+
+    // Rebuilds queue if scene or camera changed since the last build. Cached command buffers are invalidated
+    // only if that changed the draws - their order or anything else than depth
+    void UpdateRenderQueue();
+
+    void RunSortingBenchmark();
+
+    // Separate command buffer, so cached ones don't depend on uploads
+    VkCommandBuffer RecordOwnershipAcquires();
+
+    void     SubmitCommandBuffers(VkCommandBuffer const *CommandBuffers, uint32_t NumCommandBuffers);
     VkResult PresentResult(uint32_t SwapchainImageIndex);
     // !VK_COMMAND_BUFFER
     //=========================================================================================================
     // VK_SYNC
     void CreateSyncObjects();
     void DestroySyncObjects();
+
+    // One per queue, created before anything is submitted
+    void CreateTimelineSemaphores();
+    void DestroyTimelineSemaphores();
+
+    // Deleter runs once GPU finishes every frame submitted so far
+    void RetireResource(std::function<void()> &&Deleter);
     // !VK_SYNC
 
 private:
+    // Null unless host allocations are tracked, passed to every vkCreate*/vkDestroy*
+    std::unique_ptr<HostAllocationTracker> m_HostAllocationTracker;
+    VkAllocationCallbacks const           *m_pVkAllocator = nullptr;
+
     VkInstance m_VkInstance{};
 
     VkPhysicalDevice   m_VkPhysicalDevice{};
     QueueFamilyIndices m_QueueFamilyIndices{};
+    MemoryPolicy       m_MemoryPolicy{};
 
     VkDevice m_VkDevice{};
     VkQueue  m_VkGraphicsQueue{};
     VkQueue  m_VkPresentationQueue{};
+    VkQueue  m_VkTransferQueue{};
+
+    bool m_bMemoryBudgetSupported = false; // VK_EXT_memory_budget is enabled
+
+    // Indirect draw features are enabled only with --indirect-draws
+    bool     m_bMultiDrawIndirectEnabled = false;
+    bool     m_bDrawIndirectCountEnabled = false;
+    uint32_t m_MaxDrawIndirectCount      = 1; // Per indirect draw command
+
+    MemoryBudgetTracker   m_MemoryBudgetTracker;
+    DeviceMemoryAllocator m_DeviceMemoryAllocator;
+
+    VkBuffer               m_VkStagingBuffer{};
+    DeviceMemoryAllocation m_StagingBufferAllocation{};
+    StagingRing            m_StagingRing;
+    UploadBatch            m_UploadBatch;
+
+    // Uploads that frame acquires from transfer queue
+    std::vector<std::vector<QueueOwnershipAcquire>> m_FramesOwnershipAcquires;
 
     VkSurfaceKHR             m_VkSurface{};
     VkSwapchainKHR           m_VkSwapchain{};
@@ -283,43 +468,89 @@ private:
     std::vector<VkImage>     m_SwapchainImages;
     std::vector<VkImageView> m_SwapchainImagesViews;
 
-    VkDescriptorSetLayout                        m_VkMatricesUBOLayout;
-    std::array<VkBuffer, s_FramesInFlight>       m_VkMatricesUBOs;
-    std::array<VkDeviceMemory, s_FramesInFlight> m_VkMatricesUBOsMemory;
-    std::array<void *, s_FramesInFlight>         m_MatricesUBOsMappedMemory;
+    std::vector<DeviceMemoryAllocation> m_OffscreenImagesAllocations; // Headless mode only
+
+    VkDescriptorSetLayout               m_VkMatricesUBOLayout;
+    std::vector<VkBuffer>               m_VkUniformArenaBuffers;
+    std::vector<DeviceMemoryAllocation> m_UniformArenaAllocations;
+    std::vector<UniformArena>           m_UniformArenas;
+
+    // MatricesUBO and ObjectsUBO of current frame. Allocated first after reset, always in that order and size,
+    // so they are the same every frame and cached command buffers can keep them
+    uint32_t m_MatricesUBOOffset = 0;
+    uint32_t m_ObjectsUBOOffset  = 0;
 
-    VkDescriptorPool                              m_VkDescriptorPool;
-    std::array<VkDescriptorSet, s_FramesInFlight> m_VkDescriptorSets;
+    std::vector<IndirectDrawBuffer> m_IndirectDrawBuffers;
+
+    VkDescriptorPool             m_VkDescriptorPool;
+    std::vector<VkDescriptorSet> m_VkDescriptorSets;
 
     VkRenderPass     m_VkRenderPass{};
     VkPipelineLayout m_VkPipelineLayout{};
     VkPipeline       m_VkPipeline{};
+    VkPipeline       m_VkInstancedPipeline{};
+
+    static constexpr char const *s_PipelineCachePath = "./PipelineCache.bin";
+
+    PipelineCache m_PipelineCache; // Get() is VK_NULL_HANDLE with --no-pipeline-cache
 
     std::vector<VkFramebuffer> m_VkFramebuffers;
 
-    std::vector<Vertex>                              m_Vertices;
-    VkVertexInputBindingDescription                  m_VertexInputBindingDescription;
-    std::array<VkVertexInputAttributeDescription, 2> m_VertexInputAttributeDescriptions;
-    VkBuffer                                         m_VkVertexBuffer;
-    VkDeviceMemory                                   m_VkVertexBufferMemory;
+    std::vector<Vertex>                            m_Vertices;
+    std::vector<VkVertexInputBindingDescription>   m_VertexInputBindingDescriptions;
+    std::vector<VkVertexInputAttributeDescription> m_VertexInputAttributeDescriptions;
+
+    std::vector<GeometryBuffer::IndexType> m_Indices;
 
-    std::vector<uint16_t> m_Indices;
-    VkBuffer              m_VkIndexBuffer;
-    VkDeviceMemory        m_VkIndexBufferMemory;
+    GeometryBuffer m_GeometryBuffer;
+    MeshHandle     m_CubeMesh;
+
+    VkBuffer               m_VkInstanceBuffer{};
+    DeviceMemoryAllocation m_InstanceBufferAllocation{};
 
-    VkCommandPool m_VkCommandPool{};
     VkCommandPool m_VkTransferCommandPool;
 
-    std::array<VkCommandBuffer, s_FramesInFlight> m_VkCommandBuffers{};
+    // Graphics command pools and timeline value of every frame in flight
+    std::vector<FrameContext> m_FrameContexts;
+
+    std::unique_ptr<WorkerPool> m_RecordingWorkers;
+
+    // Has to be invalidated whenever anything recorded changes: pipeline, geometry, m_SceneObjects.
+    // Object transforms are read from ObjectsUBO of the frame, cached buffers hold only indices of objects
+    CommandBufferCache m_CommandBufferCache;
+
+    // CPU time spent on getting command buffers ready and state commands of all recordings, all frames
+    double               m_CommandRecordingTimeMs = 0.0;
+    CommandRecorderStats m_CommandRecorderStats;
 
-    std::array<VkSemaphore, s_FramesInFlight> m_ImageAvailableSemaphores{};
-    std::array<VkSemaphore, s_FramesInFlight> m_RenderFinishedSemaphores{};
-    std::array<VkFence, s_FramesInFlight>     m_InFlightFences{};
+    FrameLatencyTracker m_LatencyTracker;
+
+    std::vector<SceneObject> m_SceneObjects; // Everything drawn each frame
+    RenderQueue              m_RenderQueue;
+    uint32_t                 m_CubeObjectIndex = 0;
+    glm::vec3                m_CubePosition    = glm::vec3{0.0f, 0.0f, -3.0f};
+
+    // Objects or camera moved since the last build of m_RenderQueue, its order may be outdated
+    bool m_bSceneDirty = true;
+    // Queue cached command buffers were recorded from
+    std::vector<DrawPacket> m_RecordedPackets;
+
+    std::vector<VkSemaphore> m_ImageAvailableSemaphores;
+    std::vector<VkSemaphore> m_RenderFinishedSemaphores;
+
+    TimelineSemaphore m_GraphicsTimeline;
+    TimelineSemaphore m_TransferTimeline;
+
+    DeletionQueue m_DeletionQueue;
 
     VkDebugUtilsMessengerEXT m_VkDebugMessenger{};
 
     Camera    m_Camera{};
     glm::vec2 m_CursorPos{};
+
+    std::unordered_set<int> m_HeldKeys;
+
+    PresentPolicy m_PresentPolicy = PresentPolicy::LowLatency; // Switched at runtime
 };
 
 #endif // !VULKANLEARNING_VULKANAPP
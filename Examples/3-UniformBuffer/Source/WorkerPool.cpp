@@ -0,0 +1,82 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(uint32_t NumWorkers)
+{
+    NumWorkers = std::max(NumWorkers, 1u);
+
+    m_Threads.reserve(NumWorkers);
+    for (uint32_t i = 0; i < NumWorkers; ++i)
+    {
+        m_Threads.emplace_back(&WorkerPool::WorkerLoop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        m_bStopping = true;
+    }
+    m_JobReady.notify_all();
+
+    for (std::thread &Thread : m_Threads)
+    {
+        Thread.join();
+    }
+}
+
+void WorkerPool::Run(uint32_t NumJobs, Job const &WorkerJob)
+{
+    NumJobs = std::min(NumJobs, GetNumWorkers());
+    if (NumJobs == 0)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_Job            = &WorkerJob;
+    m_NumJobs        = NumJobs;
+    m_NumPendingJobs = NumJobs;
+    m_Generation++;
+    m_JobReady.notify_all();
+
+    m_JobDone.wait(Lock, [this]() { return m_NumPendingJobs == 0; });
+    m_Job = nullptr;
+}
+
+void WorkerPool::WorkerLoop(uint32_t WorkerIndex)
+{
+    uint64_t LastGeneration = 0;
+    while (true)
+    {
+        Job const *WorkerJob = nullptr;
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            m_JobReady.wait(Lock, [&]() { return m_bStopping || m_Generation != LastGeneration; });
+            if (m_bStopping)
+            {
+                return;
+            }
+            LastGeneration = m_Generation;
+
+            if (WorkerIndex >= m_NumJobs)
+            {
+                continue; // Not needed this time
+            }
+            WorkerJob = m_Job;
+        }
+
+        (*WorkerJob)(WorkerIndex);
+
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_NumPendingJobs--;
+            if (m_NumPendingJobs == 0)
+            {
+                m_JobDone.notify_one();
+            }
+        }
+    }
+}
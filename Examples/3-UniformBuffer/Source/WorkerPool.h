@@ -0,0 +1,46 @@
+#ifndef VULKANLEARNING_WORKERPOOL
+#define VULKANLEARNING_WORKERPOOL
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads that run one job per worker and block caller until all of them are done.
+// Job gets index of worker it runs on, so per-thread resources can be indexed without locking
+class WorkerPool
+{
+public:
+    using Job = std::function<void(uint32_t WorkerIndex)>;
+
+    explicit WorkerPool(uint32_t NumWorkers);
+    ~WorkerPool();
+
+    WorkerPool(WorkerPool const &)            = delete;
+    WorkerPool &operator=(WorkerPool const &) = delete;
+
+    // Runs WorkerJob on workers [0, NumJobs), NumJobs is clamped to number of workers
+    void Run(uint32_t NumJobs, Job const &WorkerJob);
+
+    uint32_t GetNumWorkers() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+private:
+    void WorkerLoop(uint32_t WorkerIndex);
+
+private:
+    std::vector<std::thread> m_Threads;
+
+    std::mutex              m_Mutex;
+    std::condition_variable m_JobReady;
+    std::condition_variable m_JobDone;
+
+    Job const *m_Job            = nullptr;
+    uint32_t   m_NumJobs        = 0;
+    uint32_t   m_NumPendingJobs = 0;
+    uint64_t   m_Generation     = 0; // Incremented by every Run, wakes workers exactly once
+    bool       m_bStopping      = false;
+};
+
+#endif // !VULKANLEARNING_WORKERPOOL
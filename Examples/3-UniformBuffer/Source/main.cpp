@@ -1,8 +1,9 @@
+#include "AppSettings.h"
 #include "VulkanApp.h"
 
-int main()
+int main(int Argc, char **Argv)
 {
     Log::Init();
-    VulkanApp App(800, 800);
+    VulkanApp App(800, 800, AppSettings::FromCommandLine(Argc, Argv));
     App.Run();
 }
\ No newline at end of file
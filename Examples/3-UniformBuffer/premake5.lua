@@ -34,6 +34,13 @@ project "3-UniformBuffer"
 		"GLFW"
 	}
 	
+	-- SPIR-V is rebuilt from shader sources before every build, binaries are never edited by hand
+	prebuildmessage "Compiling and validating shaders"
+	prebuildcommands
+	{
+		"call \"%{prj.location}/Assets/Shaders/Compile.bat\" NoPause"
+	}
+	
 	filter { "configurations:Debug" }
 		defines
 		{